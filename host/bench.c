@@ -0,0 +1,256 @@
+// Host benchmark: drives game_frame() with a scripted angler for a fixed
+// number of frames and reports wall time plus hardware traffic per frame.
+//
+//   build/host/bench [frames] [seed] [sram-file]
+//
+// In an INPUT_LOG build the session is recorded into cartridge RAM and saved
+// to sram-file; if sram-file already holds a log, it is replayed instead.
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "game.h"
+#include "hw_stub.h"
+
+#define DEFAULT_FRAMES 1000000UL
+#define DEFAULT_SEED 0x1234U
+#define CROWD_SPRITES 16        // Sprites put on one scanline by sprite_check()
+#define CROWD_FRAMES 120
+#define HIDDEN_RUN_LIMIT 2      // Most frames in a row a crowded sprite may stay hidden
+
+// Bot phases
+#define BOT_WALK 0
+#define BOT_CHARGE 1
+#define BOT_WAIT 2
+#define BOT_REEL 3
+#define BOT_PAUSE 4
+
+struct Bot {
+    uint16_t rng;
+    uint8_t phase;
+    uint16_t timer;
+    uint8_t held;
+};
+
+struct Stat {
+    unsigned long long sum;
+    uint32_t max;
+};
+
+static struct Bot bot;
+
+// The bot's own generator, so its choices never disturb the game's rng_next()
+static uint16_t bot_rand(void) {
+    bot.rng ^= bot.rng << 7;
+    bot.rng ^= bot.rng >> 9;
+    bot.rng ^= bot.rng << 8;
+    return bot.rng;
+}
+
+static void bot_next(uint8_t phase, uint16_t frames) {
+    bot.phase = phase;
+    bot.timer = frames;
+}
+
+// Input for this frame, chosen from what the game is doing
+static uint8_t bot_input(void) {
+    uint8_t keys = 0;
+
+    if(game.state == STATE_TITLE) {
+        bot.held = !bot.held;
+        return bot.held ? J_START : 0;
+    }
+
+    if(bot.timer) bot.timer--;
+
+    switch(bot.phase) {
+        case BOT_WALK:
+            keys = bot.held;
+            if(!bot.timer) bot_next(BOT_CHARGE, 16 + bot_rand() % 26);
+            break;
+
+        case BOT_CHARGE:
+            if(bot.timer) keys = J_A;
+            else bot_next(BOT_WAIT, 60 + bot_rand() % 240);
+            break;
+
+        case BOT_WAIT:
+            if(!game.is_casting) {
+                bot_next(BOT_WALK, bot_rand() % 32);
+                bot.held = (bot_rand() & 1) ? J_LEFT : J_RIGHT;
+            } else if(game.has_bite || !bot.timer) {
+                bot_next(BOT_REEL, 600);
+            }
+            break;
+
+        case BOT_REEL:
+            keys = J_B;
+            if(!game.is_casting || !bot.timer) {
+                if((bot_rand() & 15) == 0) {
+                    bot_next(BOT_PAUSE, 30 + bot_rand() % 60);
+                } else {
+                    bot_next(BOT_WALK, bot_rand() % 32);
+                    bot.held = (bot_rand() & 1) ? J_LEFT : J_RIGHT;
+                }
+            }
+            break;
+
+        case BOT_PAUSE:
+            // Tap START on the first and last frame
+            if(game.state == STATE_PLAYING && bot.timer > 1) keys = J_START;
+            if(game.state == STATE_PAUSE && bot.timer == 0) keys = J_START;
+            if(game.state == STATE_PLAYING && bot.timer == 0) bot_next(BOT_WALK, 8);
+            if(game.state == STATE_PAUSE && bot.timer > 1) bot.timer = 1;
+            break;
+    }
+    return keys;
+}
+
+// Whether the hardware shows virtual sprite id: it loses out on a line when
+// SPRITES_PER_LINE earlier OAM entries already cover that line
+static int sprite_shown(uint8_t id) {
+    const struct VSprite *s = &sprites.vs[id];
+    uint8_t line, j, n;
+
+    if(s->slot == NO_OAM_SLOT) return 0;
+    for(line = s->y > 16 ? s->y - 16 : 0; line < s->y - 8; line++) {
+        n = 0;
+        for(j = 0; j < s->slot; j++) {
+            if((uint8_t)(line + 16 - shadow_OAM[j].y) < 8) n++;
+        }
+        if(n >= SPRITES_PER_LINE) return 0;
+    }
+    return 1;
+}
+
+// Crowd one scanline with fish sprites and return the longest run of frames
+// any of them went unseen, to check the allocator's flicker takes turns
+static uint32_t sprite_check(void) {
+    uint8_t run[CROWD_SPRITES] = {0};
+    uint32_t longest = 0;
+    uint8_t f, i;
+
+    sprites_init();
+    for(i = 0; i < CROWD_SPRITES; i++) {
+        vsprite_move(FISH_SPRITE + i, 8 + i * 8, 80);
+    }
+    for(f = 0; f < CROWD_FRAMES; f++) {
+        update_sprites();
+        for(i = 0; i < CROWD_SPRITES; i++) {
+            run[i] = sprite_shown(FISH_SPRITE + i) ? 0 : run[i] + 1;
+            if(run[i] > longest) longest = run[i];
+        }
+    }
+    memset((void *)shadow_OAM, 0, sizeof(shadow_OAM));
+    return longest;
+}
+
+#ifdef INPUT_LOG
+static int sram_load(const char *path) {
+    FILE *f = fopen(path, "rb");
+    size_t n;
+
+    if(!f) return 0;
+    n = fread(hw_sram, 1, sizeof(hw_sram), f);
+    fclose(f);
+    return n == sizeof(hw_sram);
+}
+
+static int sram_save(const char *path) {
+    FILE *f = fopen(path, "wb");
+    size_t n;
+
+    if(!f) {
+        perror(path);
+        return 0;
+    }
+    n = fwrite(hw_sram, 1, sizeof(hw_sram), f);
+    fclose(f);
+    return n == sizeof(hw_sram);
+}
+#endif
+
+static void stat_add(struct Stat *s, uint32_t v) {
+    s->sum += v;
+    if(v > s->max) s->max = v;
+}
+
+static void stat_print(const char *name, const struct Stat *s, unsigned long frames) {
+    printf("%-12s avg=%.3f max=%u\n", name, (double)s->sum / frames, (unsigned)s->max);
+}
+
+int main(int argc, char **argv) {
+    unsigned long frames = DEFAULT_FRAMES;
+    unsigned seed = DEFAULT_SEED;
+    unsigned long f;
+    uint32_t before[HW_COUNT];
+    struct Stat hw[HW_COUNT] = {{0}};
+    struct Stat vram_bytes = {0}, oam_entries = {0}, fish = {0}, line_peak = {0};
+    unsigned long catches = 0;
+    uint8_t last_caught = 0;
+    uint32_t hidden_run;
+    clock_t start;
+    double secs;
+    uint8_t i;
+
+    if(argc > 1) sscanf(argv[1], "%lu", &frames);
+    if(argc > 2) sscanf(argv[2], "%i", &seed);
+    if(!frames) frames = 1;
+
+    hidden_run = sprite_check();
+    hw_reset();
+#ifdef INPUT_LOG
+    if(argc > 3 && sram_load(argv[3])) hw_joypad_state = J_SELECT;
+    init();
+    hw_joypad_state = 0;
+    if(input_log.mode == INPUT_RECORD) rng_seed(input_log_init(seed));
+#else
+    init();
+    rng_seed(seed);
+#endif
+    bot.rng = seed | 1;
+    display_title();
+
+    start = clock();
+    for(f = 0; f < frames; f++) {
+        for(i = 0; i < HW_COUNT; i++) before[i] = hw_calls[i];
+
+        hw_joypad_state = bot_input();
+        game_frame();
+
+        for(i = 0; i < HW_COUNT; i++) stat_add(&hw[i], hw_calls[i] - before[i]);
+        stat_add(&vram_bytes, vram.last_flushed);
+        stat_add(&oam_entries, sprites.oam_dirty);
+        stat_add(&fish, game.fish.active_count);
+        stat_add(&line_peak, sprites.peak);
+        if(game.fish_caught != last_caught) {
+            catches += (uint8_t)(game.fish_caught - last_caught);
+            last_caught = game.fish_caught;
+        }
+    }
+    secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("frames       %lu\n", frames);
+    printf("seed         0x%04x\n", seed);
+    printf("seconds      %.3f\n", secs);
+    printf("frames/sec   %.0f\n", secs > 0 ? frames / secs : 0.0);
+    printf("catches      %lu\n", catches);
+    printf("score        %08x\n", (unsigned)game.score);
+    for(i = 0; i < HW_COUNT; i++) stat_print(hw_names[i], &hw[i], frames);
+    stat_print("vram_bytes", &vram_bytes, frames);
+    stat_print("oam_entries", &oam_entries, frames);
+    stat_print("fish", &fish, frames);
+    stat_print("line_peak", &line_peak, frames);
+    printf("vram_stalls  %u\n", vram.stalls);
+    printf("vram_defers  %u\n", vram.deferred);
+    printf("hidden_run   %u frames with %u sprites on a line\n",
+           (unsigned)hidden_run, CROWD_SPRITES);
+    if(hidden_run > HIDDEN_RUN_LIMIT) {
+        fprintf(stderr, "sprite flicker: a sprite stayed hidden %u frames, limit %u\n",
+                (unsigned)hidden_run, HIDDEN_RUN_LIMIT);
+        return 1;
+    }
+#ifdef INPUT_LOG
+    if(argc > 3 && !sram_save(argv[3])) return 1;
+#endif
+    return 0;
+}
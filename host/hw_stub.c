@@ -0,0 +1,163 @@
+// Host hardware layer: registers and VRAM are plain memory, interrupts are
+// run synchronously from wait_vbl_done(), and each primitive counts its calls.
+#include <string.h>
+#include <gb/gb.h>
+#include <gb/cgb.h>
+#include <gb/bcd.h>
+#include <gbdk/font.h>
+#include "hw_stub.h"
+
+#define MAX_VBL_HANDLERS 4
+#define MAX_LCD_HANDLERS 4
+
+volatile uint8_t DIV_REG, LY_REG, LYC_REG, STAT_REG, LCDC_REG;
+volatile uint8_t SCX_REG, SCY_REG, WX_REG, WY_REG;
+volatile uint8_t TIMA_REG, TMA_REG, TAC_REG, IF_REG, IE_REG;
+volatile uint16_t sys_time;
+volatile uint8_t VBK_REG, HDMA1_REG, HDMA2_REG, HDMA3_REG, HDMA4_REG, HDMA5_REG;
+uint8_t _cpu = DMG_TYPE;
+
+volatile OAM_item_t shadow_OAM[40];
+volatile uint8_t _shadow_OAM_OFF;
+uint8_t _current_bank = 1;
+uint8_t hw_vram[0x2000];
+uint8_t hw_oam[sizeof(shadow_OAM)];
+_Alignas(4) uint8_t hw_sram[0x2000];
+
+uint8_t font_min[1];
+
+const char * const hw_names[HW_COUNT] = {
+    "joypad", "wait_vbl", "oam_dma", "sprite_data", "bkg_data",
+    "lcd_isr", "palette", "bcd", "font"
+};
+uint32_t hw_calls[HW_COUNT];
+uint8_t hw_joypad_state;
+
+static void (*vbl_handlers[MAX_VBL_HANDLERS])(void);
+static uint8_t vbl_count;
+static void (*lcd_handlers[MAX_LCD_HANDLERS])(void);
+static uint8_t lcd_count;
+
+void hw_reset(void) {
+    memset(hw_calls, 0, sizeof(hw_calls));
+}
+
+void set_sprite_data(uint8_t first_tile, uint8_t nb_tiles, const uint8_t *data) {
+    hw_calls[HW_SPRITE_DATA]++;
+    memcpy(hw_vram + first_tile * 16, data, nb_tiles * 16);
+}
+
+void set_bkg_data(uint8_t first_tile, uint8_t nb_tiles, const uint8_t *data) {
+    uint16_t offset = first_tile < 128 ? 0x1000 + first_tile * 16 : first_tile * 16;
+
+    hw_calls[HW_BKG_DATA]++;
+    memcpy(hw_vram + offset, data, nb_tiles * 16);
+}
+
+void set_bkg_palette(uint8_t first_palette, uint8_t nb_palettes, const uint16_t *rgb_data) {
+    (void)first_palette; (void)nb_palettes; (void)rgb_data;
+    hw_calls[HW_PALETTE]++;
+}
+
+void set_sprite_palette(uint8_t first_palette, uint8_t nb_palettes, const uint16_t *rgb_data) {
+    (void)first_palette; (void)nb_palettes; (void)rgb_data;
+    hw_calls[HW_PALETTE]++;
+}
+
+void cpu_fast(void) {
+}
+
+uint8_t joypad(void) {
+    hw_calls[HW_JOYPAD]++;
+    return hw_joypad_state;
+}
+
+void add_VBL(void (*h)(void)) {
+    if(vbl_count < MAX_VBL_HANDLERS) vbl_handlers[vbl_count++] = h;
+}
+
+void add_LCD(void (*h)(void)) {
+    if(lcd_count < MAX_LCD_HANDLERS) lcd_handlers[lcd_count++] = h;
+}
+
+void set_interrupts(uint8_t flags) {
+    IE_REG = flags;
+}
+
+// One whole frame passes here. The visible lines come first, with the LCD
+// handlers run on each LYC match; then the OAM DMA and the VBL handlers run
+// in the same order as the GBDK VBlank interrupt does.
+void wait_vbl_done(void) {
+    uint8_t i;
+
+    hw_calls[HW_WAIT_VBL]++;
+    if((IE_REG & LCD_IFLAG) && (STAT_REG & STATF_LYC)) {
+        for(LY_REG = 0; LY_REG < 144; LY_REG++) {
+            if(LY_REG != LYC_REG) continue;
+            hw_calls[HW_LCD_ISR]++;
+            for(i = 0; i < lcd_count; i++) lcd_handlers[i]();
+        }
+    }
+    LY_REG = 144;
+    if(!_shadow_OAM_OFF) {
+        hw_calls[HW_OAM_DMA]++;
+        memcpy(hw_oam, (const void *)shadow_OAM, sizeof(hw_oam));
+    }
+    for(i = 0; i < vbl_count; i++) vbl_handlers[i]();
+    sys_time++;
+    DIV_REG += 70;  // 70224 cycles / 256 per frame, truncated
+    LY_REG = 0;
+}
+
+void uint2bcd(uint16_t i, BCD *value) {
+    BCD v = 0;
+    uint8_t shift = 0;
+
+    hw_calls[HW_BCD]++;
+    while(i) {
+        v |= (BCD)(i % 10) << shift;
+        i /= 10;
+        shift += 4;
+    }
+    *value = v;
+}
+
+void bcd_add(BCD *sour, const BCD *value) {
+    BCD a = *sour, b = *value, r = 0;
+    uint8_t shift, carry = 0;
+
+    hw_calls[HW_BCD]++;
+    for(shift = 0; shift < 32; shift += 4) {
+        uint8_t d = ((a >> shift) & 0xF) + ((b >> shift) & 0xF) + carry;
+        carry = d > 9;
+        if(carry) d -= 10;
+        r |= (BCD)d << shift;
+    }
+    *sour = r;
+}
+
+uint8_t bcd2text(const BCD *bcd, uint8_t tile_offset, uint8_t *buffer) {
+    uint8_t i;
+
+    hw_calls[HW_BCD]++;
+    for(i = 0; i < 8; i++) {
+        buffer[i] = ((*bcd >> (28 - i * 4)) & 0xF) + tile_offset;
+    }
+    buffer[8] = 0;
+    return 8;
+}
+
+void font_init(void) {
+    hw_calls[HW_FONT]++;
+}
+
+font_t font_load(void *font) {
+    (void)font;
+    hw_calls[HW_FONT]++;
+    return 1;
+}
+
+void font_set(font_t font_handle) {
+    (void)font_handle;
+    hw_calls[HW_FONT]++;
+}
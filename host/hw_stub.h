@@ -0,0 +1,28 @@
+// Hooks into the host hardware stub for the bench driver
+#ifndef HW_STUB_H
+#define HW_STUB_H
+
+#include <stdint.h>
+
+// Calls into each hardware primitive, plus bytes moved on the game's behalf
+enum {
+    HW_JOYPAD,
+    HW_WAIT_VBL,
+    HW_OAM_DMA,
+    HW_SPRITE_DATA,
+    HW_BKG_DATA,
+    HW_LCD_ISR,
+    HW_PALETTE,
+    HW_BCD,
+    HW_FONT,
+    HW_COUNT
+};
+
+extern const char * const hw_names[HW_COUNT];
+extern uint32_t hw_calls[HW_COUNT];
+
+extern uint8_t hw_joypad_state;  // what the next joypad() call returns
+
+void hw_reset(void);
+
+#endif
@@ -0,0 +1,16 @@
+// Host stand-in for GBDK's <gb/bcd.h>: 8 packed decimal digits in a uint32_t
+#ifndef HOST_BCD_H
+#define HOST_BCD_H
+
+#include <stdint.h>
+
+typedef uint32_t BCD;
+
+#define BCD_HEX(v) ((BCD)(v))
+#define MAKE_BCD(v) BCD_HEX(0x ## v)
+
+void uint2bcd(uint16_t i, BCD *value);
+void bcd_add(BCD *sour, const BCD *value);
+uint8_t bcd2text(const BCD *bcd, uint8_t tile_offset, uint8_t *buffer);
+
+#endif
@@ -0,0 +1,14 @@
+// Host stand-in for GBDK's <gb/cgb.h>: palette loads are counted, and the
+// CPU speed switch does nothing since the host never reports a CGB.
+#ifndef HOST_CGB_H
+#define HOST_CGB_H
+
+#include <stdint.h>
+
+#define RGB(r, g, b) ((uint16_t)((r) | ((g) << 5) | ((b) << 10)))
+
+void set_bkg_palette(uint8_t first_palette, uint8_t nb_palettes, const uint16_t *rgb_data);
+void set_sprite_palette(uint8_t first_palette, uint8_t nb_palettes, const uint16_t *rgb_data);
+void cpu_fast(void);
+
+#endif
@@ -0,0 +1,101 @@
+// Host stand-in for GBDK's <gb/gb.h>. Only what the game uses is here; the
+// registers and VRAM are plain memory and every call is counted by
+// host/hw_stub.c so the bench can report hardware traffic per frame.
+#ifndef HOST_GB_H
+#define HOST_GB_H
+
+#include <stdint.h>
+
+#define J_START  0x80U
+#define J_SELECT 0x40U
+#define J_B      0x20U
+#define J_A      0x10U
+#define J_DOWN   0x08U
+#define J_UP     0x04U
+#define J_LEFT   0x02U
+#define J_RIGHT  0x01U
+
+#define S_PALETTE  0x10U
+#define S_FLIPX    0x20U
+#define S_FLIPY    0x40U
+#define S_PRIORITY 0x80U
+
+#define LCDCF_BGON  0x01U
+#define LCDCF_OBJON 0x02U
+#define LCDCF_OBJ16 0x04U
+#define LCDCF_BG9C00 0x08U
+#define LCDCF_WINON  0x20U
+#define LCDCF_WIN9C00 0x40U
+#define LCDCF_ON    0x80U
+
+extern volatile uint8_t DIV_REG, LY_REG, LYC_REG, STAT_REG, LCDC_REG;
+extern volatile uint8_t SCX_REG, SCY_REG, WX_REG, WY_REG;
+extern volatile uint8_t TIMA_REG, TMA_REG, TAC_REG, IF_REG, IE_REG;
+extern volatile uint16_t sys_time;
+extern volatile uint8_t VBK_REG, HDMA1_REG, HDMA2_REG, HDMA3_REG, HDMA4_REG, HDMA5_REG;
+
+// The host always reports a DMG, so the CGB paths are compiled but not run
+#define DMG_TYPE 0x01U
+#define CGB_TYPE 0x11U
+extern uint8_t _cpu;
+
+#define VBK_TILES      0U
+#define VBK_ATTRIBUTES 1U
+
+#define TACF_START  0x04U
+#define TACF_262KHZ 0x01U
+
+#define STATF_LYC   0x40U
+#define STATF_BUSY  0x02U
+#define VBL_IFLAG   0x01U
+#define LCD_IFLAG   0x02U
+
+#define SPRITES_8x8  (LCDC_REG &= ~LCDCF_OBJ16)
+#define SHOW_BKG     (LCDC_REG |= LCDCF_BGON)
+#define SHOW_SPRITES (LCDC_REG |= LCDCF_OBJON)
+#define DISPLAY_ON   (LCDC_REG |= LCDCF_ON)
+#define DISPLAY_OFF  (LCDC_REG &= ~LCDCF_ON)
+
+typedef struct OAM_item_t {
+    uint8_t y, x, tile, prop;
+} OAM_item_t;
+
+extern volatile OAM_item_t shadow_OAM[40];
+extern volatile uint8_t _shadow_OAM_OFF;
+#define DISABLE_OAM_DMA (_shadow_OAM_OFF = 1)
+#define ENABLE_OAM_DMA  (_shadow_OAM_OFF = 0)
+
+// 8000-9FFF as one block so the game's direct writes land somewhere real
+extern uint8_t hw_vram[0x2000];
+#define _VRAM8000 (hw_vram)
+#define _SCRN0    (hw_vram + 0x1800)
+#define _SCRN1    (hw_vram + 0x1C00)
+
+// One 8K bank of cartridge RAM at A000; the enable latch is not modelled
+extern uint8_t hw_sram[0x2000];
+#define _SRAM (hw_sram)
+#define ENABLE_RAM
+#define DISABLE_RAM
+
+// One flat address space: banked calls are plain calls and switching only
+// records the bank
+#define BANKED
+#define NONBANKED
+extern uint8_t _current_bank;
+#define CURRENT_BANK _current_bank
+#define SWITCH_ROM(b) (_current_bank = (b))
+
+// Interrupts only ever run from wait_vbl_done(), so there is nothing to mask
+#define disable_interrupts()
+#define enable_interrupts()
+#define WAIT_INTERRUPT() wait_vbl_done()
+
+void set_sprite_data(uint8_t first_tile, uint8_t nb_tiles, const uint8_t *data);
+void set_bkg_data(uint8_t first_tile, uint8_t nb_tiles, const uint8_t *data);
+uint8_t joypad(void);
+void wait_vbl_done(void);
+void add_VBL(void (*h)(void));
+void add_LCD(void (*h)(void));
+void set_interrupts(uint8_t flags);
+
+#endif
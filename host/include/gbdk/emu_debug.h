@@ -0,0 +1,9 @@
+// Host stand-in for GBDK's <gbdk/emu_debug.h>: the debug channel is stdout
+#ifndef HOST_EMU_DEBUG_H
+#define HOST_EMU_DEBUG_H
+
+#include <stdio.h>
+
+#define EMU_printf(...) (printf(__VA_ARGS__), putchar('\n'))
+
+#endif
@@ -0,0 +1,15 @@
+// Host stand-in for GBDK's <gbdk/font.h>; font tiles are not modelled
+#ifndef HOST_FONT_H
+#define HOST_FONT_H
+
+#include <stdint.h>
+
+typedef uint16_t font_t;
+
+extern uint8_t font_min[];
+
+void font_init(void);
+font_t font_load(void *font);
+void font_set(font_t font_handle);
+
+#endif
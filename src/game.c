@@ -0,0 +1,1696 @@
+#include "game.h"
+
+// Tile sheets are in assets/ and compressed into build/gen/assets.c by
+// tools/assets.py; asset_load() unpacks them into VRAM
+
+// Points awarded, kept in BCD so scoring never needs a divide
+const BCD bite_points = MAKE_BCD(10);
+const BCD catch_points[] = {MAKE_BCD(100), MAKE_BCD(200), MAKE_BCD(300)};
+
+// Water wave frames, each one row further down. Frames 0 and 1 match the
+// Water 1 and Water 2 background tiles.
+const unsigned char water_frame_data[] = {
+    0x00, 0x00, 0x40, 0x40, 0x00, 0x00, 0x20, 0x20,
+    0x00, 0x00, 0x40, 0x40, 0x00, 0x00, 0x20, 0x20,
+
+    0x20, 0x20, 0x00, 0x00, 0x40, 0x40, 0x00, 0x00,
+    0x20, 0x20, 0x00, 0x00, 0x40, 0x40, 0x00, 0x00,
+
+    0x00, 0x00, 0x20, 0x20, 0x00, 0x00, 0x40, 0x40,
+    0x00, 0x00, 0x20, 0x20, 0x00, 0x00, 0x40, 0x40,
+
+    0x40, 0x40, 0x00, 0x00, 0x20, 0x20, 0x00, 0x00,
+    0x40, 0x40, 0x00, 0x00, 0x20, 0x20, 0x00, 0x00
+};
+
+// Every water cell uses WATER_TILE, so one 16-byte upload animates them all
+struct TileAnimation water_anim = {
+    .num_frames = 4,
+    .frame_tiles = NULL,
+    .current_frame = 0,
+    .frame_delay = 15,
+    .ticks_left = 15,
+    .mode = ANIM_MODE_PATTERN,
+    .target_tile = WATER_TILE,
+    .frame_data = water_frame_data
+};
+
+struct GameState game;
+struct VramQueue vram;
+struct FrameClock frame_clock;
+struct Scheduler sched;
+struct Raster raster;
+struct SpriteAllocator sprites;
+uint16_t rng_state = RNG_SEED_DEFAULT;
+uint8_t cgb;
+
+// 256 byte staging buffer, 16-byte aligned as the CGB VRAM DMA requires
+static uint8_t dma_store[256 + 15];
+#define DMA_BUF ((uint8_t *)(((uintptr_t)dma_store + 15) & ~(uintptr_t)15))
+
+// CGB palette of each background tile, from BKG_TILE_BASE
+static const uint8_t bkg_tile_palette[BACKGROUND_TILES] = {
+    BKG_PAL_SKY, BKG_PAL_SKY, BKG_PAL_WATER, BKG_PAL_WATER,
+    BKG_PAL_PIER, BKG_PAL_POST, BKG_PAL_SKY, BKG_PAL_SKY
+};
+
+// Wait for the VBlank handler to free room for a command and its row bytes
+struct VramCmd *vram_reserve(uint8_t bytes) {
+    while(((vram.cmd_tail + 1) & (VRAM_QUEUE_SIZE - 1)) == vram.cmd_head ||
+          (uint8_t)(vram.arena_tail - vram.arena_head) > (uint8_t)(255 - bytes)) {
+        vram.stalls++;
+        wait_vbl_done();
+    }
+    return &vram.cmds[vram.cmd_tail];
+}
+
+void vram_commit(uint16_t bytes) {
+    vram.queued += bytes;
+    vram.cmd_tail = (vram.cmd_tail + 1) & (VRAM_QUEUE_SIZE - 1);
+}
+
+// Queue a row of BG map tiles. The tiles are copied, so stack buffers are fine.
+void vram_queue_row(uint8_t x, uint8_t y, uint8_t width, const uint8_t *tiles) {
+    struct VramCmd *cmd = vram_reserve(width);
+    cmd->type = VRAM_CMD_ROW;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->len = width;
+    cmd->src = vram.arena_tail;
+    for(uint8_t i = 0; i < width; i++) {
+        vram.arena[vram.arena_tail++] = tiles[i];
+    }
+    vram_commit(width);
+}
+
+// Queue a run of one BG map tile
+void vram_queue_fill(uint8_t x, uint8_t y, uint8_t width, uint8_t tile) {
+    struct VramCmd *cmd = vram_reserve(0);
+    cmd->type = VRAM_CMD_FILL;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->len = width;
+    cmd->tile = tile;
+    vram_commit(width);
+}
+
+// Queue tile pattern uploads. The data is not copied and must outlive the flush.
+void vram_queue_data(uint8_t first_tile, uint8_t count, const uint8_t *data) {
+    struct VramCmd *cmd = vram_reserve(0);
+    cmd->type = VRAM_CMD_DATA;
+    cmd->tile = first_tile;
+    cmd->len = count;
+    cmd->data = data;
+    vram_commit((uint16_t)count << 4);
+}
+
+// Queue BG map tiles that are already in ROM. Not copied, like pattern data.
+void vram_queue_map(uint8_t x, uint8_t y, uint8_t width, const uint8_t *tiles) {
+    struct VramCmd *cmd = vram_reserve(0);
+    cmd->type = VRAM_CMD_MAP;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->len = width;
+    cmd->data = tiles;
+    vram_commit(width);
+}
+
+// Queue a change to the LCDC bits in mask, such as flipping the BG map or
+// showing the window. It happens in VBlank once everything queued before it
+// is written, so a screen is never shown half drawn.
+void vram_queue_lcdc(uint8_t mask, uint8_t bits) {
+    struct VramCmd *cmd = vram_reserve(0);
+    cmd->type = VRAM_CMD_LCDC;
+    cmd->len = 0;
+    cmd->x = mask;
+    cmd->tile = bits;
+    if(mask & LCDCF_BG9C00) {
+        vram.front = (bits & LCDCF_BG9C00) ? GAME_ROW : TITLE_ROW;
+    }
+    vram_commit(0);
+}
+
+// VBlank handler: drain queued writes up to the per-frame budget.
+// Whatever doesn't fit stays queued for the next VBlank.
+void vram_flush() {
+    uint8_t budget = VRAM_BUDGET_BYTES;
+
+    while(vram.cmd_head != vram.cmd_tail) {
+        struct VramCmd *cmd = &vram.cmds[vram.cmd_head];
+        const uint8_t *src;
+        uint8_t n;
+
+        // Leave the rest for the next VBlank rather than write into mode 3
+        if(LY_REG < SCREEN_LINES) break;
+
+        if(cmd->type == VRAM_CMD_LCDC) {
+            LCDC_REG = (LCDC_REG & ~cmd->x) | cmd->tile;
+            vram.cmd_head = (vram.cmd_head + 1) & (VRAM_QUEUE_SIZE - 1);
+            continue;
+        }
+        if(cmd->type == VRAM_CMD_DATA) {
+            n = budget >> 4;
+            if(!n) break;
+            if(n > cmd->len) n = cmd->len;
+
+            // Locals and an 8-bit count keep SDCC's loop at ld/inc/ld/dec/jr
+            uint8_t *dst = _VRAM8000 + ((uint16_t)cmd->tile << 4);
+            uint8_t count = n << 4;
+            src = cmd->data;
+            do { *dst++ = *src++; } while(--count);
+            cmd->data = src;
+            cmd->tile += n;
+            budget -= n << 4;
+        } else {
+            n = budget;
+            if(!n) break;
+            if(n > cmd->len) n = cmd->len;
+
+            uint8_t *dst = _SCRN0 + ((uint16_t)cmd->y << 5) + cmd->x;
+            if(cmd->type == VRAM_CMD_FILL) {
+                for(uint8_t i = 0; i < n; i++) *dst++ = cmd->tile;
+            } else if(cmd->type == VRAM_CMD_MAP) {
+                src = cmd->data;
+                for(uint8_t i = 0; i < n; i++) *dst++ = *src++;
+                cmd->data = src;
+            } else {
+                for(uint8_t i = 0; i < n; i++) *dst++ = vram.arena[cmd->src++];
+                vram.arena_head += n;
+            }
+            cmd->x += n;
+            budget -= n;
+        }
+
+        cmd->len -= n;
+        if(!cmd->len) {
+            vram.cmd_head = (vram.cmd_head + 1) & (VRAM_QUEUE_SIZE - 1);
+        }
+    }
+
+    vram.last_flushed = VRAM_BUDGET_BYTES - budget;
+    vram.flushed += vram.last_flushed;
+    if(vram.cmd_head != vram.cmd_tail) {
+        vram.deferred++;
+    }
+}
+
+// The VBlank handler. GBDK has already run the OAM DMA if it was enabled;
+// this counts the frame for the logic loop, applies the scroll and drains
+// the VRAM queue, then times itself with TIMA.
+void vbl_isr() {
+    uint8_t start = TIMA_REG;
+    uint8_t cost;
+
+    if(frame_clock.pending != 255) frame_clock.pending++;
+    DISABLE_OAM_DMA;  // Copied; update_sprites() turns it back on for changes
+    SCX_REG = frame_clock.scx;
+    SCY_REG = frame_clock.scy;
+    raster_vbl();
+    vram_flush();
+
+    cost = TIMA_REG - start;
+    frame_clock.isr_cost = cost;
+    if(cost > frame_clock.isr_max) frame_clock.isr_max = cost;
+}
+
+// SCX offset of each shimmer band, one sine cycle
+static const int8_t shimmer_wave[SHIMMER_WAVE] = {
+    0, 1, 1, 2, 2, 2, 1, 1, 0, -1, -1, -2, -2, -2, -1, -1
+};
+
+// LCD interrupt on LYC: apply this line's scroll and arm the next line
+void raster_isr() {
+    uint8_t start = TIMA_REG;
+    const struct RasterTable *t = &raster.tables[raster.front];
+    uint8_t i = raster.next;
+
+    // Armed a line early: write SCX in that line's HBlank, not in mode 3
+    while(STAT_REG & STATF_BUSY);
+    SCX_REG = t->scx[i];
+    i++;
+    LYC_REG = i < t->count ? t->line[i] - 1 : RASTER_LYC_OFF;
+    raster.next = i;
+    raster.cost += (uint8_t)(TIMA_REG - start);
+}
+
+// From the VBlank handler: take a finished table, arm its first line and
+// close the books on the frame that just ended
+void raster_vbl() {
+    const struct RasterTable *t;
+
+    if(raster.ready) {
+        raster.front ^= 1;
+        raster.ready = 0;
+    }
+    t = &raster.tables[raster.front];
+    raster.frame_irqs = raster.next;
+    raster.next = 0;
+    LYC_REG = t->count ? t->line[0] - 1 : RASTER_LYC_OFF;
+
+    raster.frame_cost = raster.cost;
+    if(raster.cost > raster.cost_max) raster.cost_max = raster.cost;
+    raster.cost = 0;
+}
+
+// Fill the back table from the current offsets. Skipped while the last
+// build is still waiting for its VBlank or nothing has changed.
+void raster_build() {
+    struct RasterTable *t;
+    uint8_t base = frame_clock.scx;
+    uint8_t n = 0;
+
+    if(raster.ready || !raster.dirty) return;
+    t = &raster.tables[raster.front ^ 1];
+
+    if(raster.active) {
+        t->line[n] = CLOUD_TOP;
+        t->scx[n++] = base + raster.cloud_x;
+        t->line[n] = CLOUD_BOTTOM;
+        t->scx[n++] = base;
+
+        // The HUD window covers the rest, and the window ignores SCX
+        uint8_t w = raster.phase;
+        for(uint8_t y = SHIMMER_TOP; y < HUD_WY; y += SHIMMER_STEP) {
+            t->line[n] = y;
+            t->scx[n++] = base + shimmer_wave[w++ & (SHIMMER_WAVE - 1)];
+        }
+    }
+    t->count = n;
+    raster.dirty = 0;
+    raster.ready = 1;
+}
+
+void raster_start() {
+    raster.active = 1;
+    raster.dirty = 1;
+    raster_build();
+}
+
+// Back to a single scroll for the whole frame from the next VBlank
+void raster_stop() {
+    raster.active = 0;
+    raster.dirty = 1;
+    raster_build();
+}
+
+// Once per gameplay tick: step the effects that are due and rebuild
+void update_raster() {
+    if(TASK_DUE(TASK_CLOUDS)) {
+        raster.cloud_x++;
+        raster.dirty = 1;
+    }
+    if(TASK_DUE(TASK_SHIMMER)) {
+        raster.phase++;
+        raster.dirty = 1;
+    }
+    raster_build();
+}
+
+// Drop every queued write. Only for when the whole screen is about to be
+// replaced, so nothing pending is still wanted.
+void vram_discard() {
+    disable_interrupts();
+    while(vram.cmd_head != vram.cmd_tail) {
+        struct VramCmd *cmd = &vram.cmds[vram.cmd_head];
+        vram.discarded += cmd->type == VRAM_CMD_DATA ? (uint16_t)cmd->len << 4 : cmd->len;
+        vram.cmd_head = (vram.cmd_head + 1) & (VRAM_QUEUE_SIZE - 1);
+    }
+    vram.arena_head = vram.arena_tail;
+    enable_interrupts();
+}
+
+// CGB: copy len bytes (a multiple of 16, both ends 16-byte aligned) to VRAM
+// by DMA. With the LCD off it all goes at once while the CPU waits; with it on
+// 16 bytes move in each HBlank, and this waits for the last of them.
+void vram_dma(uint16_t dst, const uint8_t *src, uint16_t len) {
+    HDMA1_REG = (uint8_t)((uintptr_t)src >> 8);
+    HDMA2_REG = (uint8_t)(uintptr_t)src;
+    HDMA3_REG = dst >> 8;
+    HDMA4_REG = (uint8_t)dst;
+    if(LCDC_REG & LCDCF_ON) {
+        HDMA5_REG = HDMA_HBLANK | ((len >> 4) - 1);
+        while(!(HDMA5_REG & HDMA_HBLANK));  // Reads 0xFF once finished
+    } else {
+        HDMA5_REG = (len >> 4) - 1;
+    }
+}
+
+// CGB: set the attribute map (VRAM bank 1) behind a whole screen to the
+// palette of each tile in map. Attributes are built 8 rows at a time in the
+// DMA buffer. LCD off only, as nothing else expects VRAM bank 1 selected.
+void cgb_map_attributes(uint8_t row, const uint8_t *map) {
+    uint8_t *buf = DMA_BUF;
+
+    VBK_REG = VBK_ATTRIBUTES;
+    for(uint8_t chunk = 0; chunk < MAP_SIZE / 256; chunk++) {
+        uint8_t i = 0;
+        do {
+            uint8_t t = *map++ - BKG_TILE_BASE;
+            buf[i] = t < BACKGROUND_TILES ? bkg_tile_palette[t] : BKG_PAL_SKY;
+        } while(++i);
+        vram_dma(0x9800 + ((uint16_t)(row + (chunk << 3)) << 5), buf, 256);
+    }
+    VBK_REG = VBK_TILES;
+}
+
+// Unpack an asset into VRAM from first_tile on, through set_bkg_data() or
+// set_sprite_data(), or DMA on CGB. Output goes through a 256 byte ring that
+// is both the match history and the copy source: 16 tiles fill it exactly,
+// so each batch is contiguous and starts where the byte index wraps to zero.
+// The asset's bank is switched in for the load and the caller's restored,
+// so banked code can call this too.
+void asset_load(const struct Asset *asset, uint8_t first_tile, uint8_t target) {
+    uint8_t *ring = DMA_BUF;
+    const uint8_t *src = asset->data;
+    uint8_t pos = 0;
+    uint8_t from = 0;
+    uint8_t literals = 0;
+    uint8_t copies = 0;
+    uint8_t batch = 0;
+    uint8_t caller_bank = CURRENT_BANK;
+#ifdef PROFILE
+    uint8_t start = DIV_REG;
+#endif
+
+    SWITCH_ROM(asset->bank);
+    for(uint8_t t = 0; t < asset->tiles; t++) {
+        for(uint8_t n = 16; n; n--) {
+            if(!literals && !copies) {
+                uint8_t c = *src++;
+                if(c & 0x80) {
+                    copies = (c & 0x7F) + ASSET_MIN_MATCH;
+                    from = pos - *src++ - 1;
+                } else {
+                    literals = c + 1;
+                }
+            }
+            if(literals) {
+                ring[pos++] = *src++;
+                literals--;
+            } else {
+                ring[pos++] = ring[from++];
+                copies--;
+            }
+        }
+
+        batch++;
+        if(!pos || t + 1 == asset->tiles) {
+            uint8_t first = first_tile + t + 1 - batch;
+            if(cgb && (target == ASSET_SPRITE || first >= 128 || first + batch <= 128)) {
+                // BG tiles below 128 are at 9000, the rest share 8800 with sprites
+                uint16_t base = target == ASSET_SPRITE || first >= 128 ? 0x8000 : 0x9000;
+                vram_dma(base + ((uint16_t)first << 4), ring, (uint16_t)batch << 4);
+            } else if(target == ASSET_SPRITE) {
+                set_sprite_data(first, batch, ring);
+            } else {
+                set_bkg_data(first, batch, ring);
+            }
+            batch = 0;
+        }
+    }
+    SWITCH_ROM(caller_bank);
+#ifdef PROFILE
+    EMU_printf("PROF asset=%s raw=%u packed=%u clocks=%u", asset->name,
+               (uint16_t)asset->tiles << 4, asset->packed,
+               (uint16_t)(uint8_t)(DIV_REG - start) << 8);
+#endif
+}
+
+// Rebuild rows of the gameplay screen from ROM at the given queue row
+void restore_rows(uint8_t row, uint8_t first, uint8_t count) {
+    for(uint8_t y = first; y < first + count; y++) {
+        vram_queue_map(0, row + y, SCREEN_WIDTH, &gameplay_map[(uint16_t)y * MAP_WIDTH]);
+    }
+}
+
+// Map ASCII to font_min tiles and queue it; anything else becomes a blank
+void draw_text(uint8_t x, uint8_t y, const char *text) {
+    uint8_t tiles[SCREEN_WIDTH];
+    uint8_t len = 0;
+
+    while(*text && len < SCREEN_WIDTH) {
+        char c = *text++;
+        if(c >= 'a' && c <= 'z') c -= 'a' - 'A';
+
+        if(c >= '0' && c <= '9') {
+            tiles[len++] = FONT_TILE_DIGIT0 + (c - '0');
+        } else if(c >= 'A' && c <= 'Z') {
+            tiles[len++] = FONT_TILE_ALPHA + (c - 'A');
+        } else {
+            tiles[len++] = FONT_TILE_BLANK;
+        }
+    }
+    vram_queue_row(x, y, len, tiles);
+}
+
+// -1, 0 or +1 from a random nibble, with no divide by three.
+// Sixteen doesn't split three ways, so the extra entry goes to zero.
+static const int8_t jitter_lut[16] = {
+    -1, 0, 1, -1, 0, 1, -1, 0, 1, -1, 0, 1, -1, 0, 1, 0
+};
+#define RNG_JITTER(r) jitter_lut[(r) & 0x0F]
+
+void rng_seed(uint16_t seed) {
+    rng_state = seed ? seed : RNG_SEED_DEFAULT;
+}
+
+// xorshift16 with shifts 7, 9, 8: period 65535 and no multiply or divide.
+// Callers pull as many bits as they need out of one result.
+uint16_t rng_next() {
+    uint16_t s = rng_state;
+    s ^= s << 7;
+    s ^= s >> 9;
+    s ^= s << 8;
+    rng_state = s;
+    return s;
+}
+
+#ifdef INPUT_LOG
+struct InputLog input_log;
+
+#define input_header ((struct InputLogHeader *)_SRAM)
+#define input_runs ((struct InputRun *)(_SRAM + sizeof(struct InputLogHeader)))
+
+// Choose replay (SELECT held and a log saved) or record, and return the seed
+// to give rng_seed(). Calling it again restarts the recording with a new seed.
+uint16_t input_log_init(uint16_t seed) {
+    ENABLE_RAM;
+    if((joypad() & J_SELECT) && input_header->magic == INPUT_LOG_MAGIC && input_header->runs) {
+        input_log.mode = INPUT_REPLAY;
+        input_log.run = 0;
+        input_log.left = input_runs[0].length;
+        seed = input_header->seed;
+        EMU_printf("INPUT REPLAY seed=%x runs=%u", seed, input_header->runs);
+    } else {
+        input_log.mode = INPUT_RECORD;
+        input_log.run = 0;
+        input_header->magic = INPUT_LOG_MAGIC;
+        input_header->seed = seed;
+        input_header->runs = 0;
+        EMU_printf("INPUT RECORD seed=%x", seed);
+    }
+    DISABLE_RAM;
+    return seed;
+}
+
+// Pass one frame of joypad input through the log. Recording extends or
+// starts a run and echoes finished runs to the debug channel; replaying
+// ignores the pad until the log runs out, then hands control back.
+uint8_t input_log_next(uint8_t live) {
+    struct InputRun *r;
+
+    if(input_log.mode == INPUT_LIVE) return live;
+
+    ENABLE_RAM;
+    r = &input_runs[input_log.run];
+    if(input_log.mode == INPUT_REPLAY) {
+        if(!input_log.left) {
+            if(input_log.run + 1 >= input_header->runs) {
+                input_log.mode = INPUT_LIVE;
+                EMU_printf("INPUT REPLAY END");
+                DISABLE_RAM;
+                return live;
+            }
+            input_log.run++;
+            r++;
+            input_log.left = r->length;
+        }
+        input_log.left--;
+        live = r->input;
+    } else if(input_header->runs && r->input == live && r->length < 255) {
+        r->length++;
+    } else {
+        if(input_header->runs) {
+            EMU_printf("INPUT %hu %hx", r->length, r->input);
+            if(input_log.run + 1 >= INPUT_LOG_RUNS) {
+                input_log.mode = INPUT_LIVE;
+                EMU_printf("INPUT LOG FULL");
+                DISABLE_RAM;
+                return live;
+            }
+            input_log.run++;
+            r++;
+        }
+        r->length = 1;
+        r->input = live;
+        input_header->runs = input_log.run + 1;
+    }
+    DISABLE_RAM;
+    return live;
+}
+#endif
+
+#ifdef PROFILE
+struct Profiler prof;
+
+const char * const profile_names[PROF_COUNT] = {
+    "INP", "HIN", "GAM", "FSH", "LIN", "MTR", "SCO", "REG", "SPR"
+};
+
+void profile_reset() {
+    for(uint8_t i = 0; i < PROF_COUNT; i++) {
+        prof.stat[i].min = 0xFF;
+        prof.stat[i].max = 0;
+        prof.stat[i].sum = 0;
+        prof.stat[i].runs = 0;
+    }
+    prof.frames = 0;
+}
+
+void profile_end(uint8_t id) {
+    struct ProfileStat *stat = &prof.stat[id];
+    uint8_t start = prof.start[id];
+    uint8_t end = LY_REG;
+
+    // LY runs 0-153, so a phase that crossed line 0 wrapped once
+    uint8_t lines = end >= start ? end - start : end + 154 - start;
+    if(lines < stat->min) stat->min = lines;
+    if(lines > stat->max) stat->max = lines;
+    stat->sum += lines;
+    stat->runs++;
+}
+
+// Lines per run, so catch-up ticks don't inflate phases that run per tick
+uint16_t profile_avg(const struct ProfileStat *stat) {
+    return stat->runs ? stat->sum / stat->runs : 0;
+}
+
+// Write three digits of a small count into tiles
+void profile_digits(uint8_t *tiles, uint16_t value) {
+    BCD bcd;
+    uint8_t text[9];
+    uint2bcd(value, &bcd);
+    bcd2text(&bcd, FONT_TILE_DIGIT0, text);
+    tiles[0] = text[5];
+    tiles[1] = text[6];
+    tiles[2] = text[7];
+}
+
+// Draw "NAME MIN AVG MAX" rows over the lower half of the screen
+void profile_draw_overlay() {
+    uint8_t row[15];
+
+    for(uint8_t i = 0; i < PROF_COUNT; i++) {
+        struct ProfileStat *stat = &prof.stat[i];
+        memset(row, FONT_TILE_BLANK, sizeof(row));
+        for(uint8_t c = 0; c < 3; c++) {
+            row[c] = FONT_TILE_ALPHA + (profile_names[i][c] - 'A');
+        }
+        profile_digits(&row[4], stat->min);
+        profile_digits(&row[8], profile_avg(stat));
+        profile_digits(&row[12], stat->max);
+        vram_queue_row(0, GAME_ROW + 7 + i, sizeof(row), row);
+    }
+
+    draw_text(0, GAME_ROW + 7 + PROF_COUNT, "MISSED");
+    memset(row, FONT_TILE_BLANK, sizeof(row));
+    profile_digits(&row[0], prof.missed_vblanks);
+    vram_queue_row(7, GAME_ROW + 7 + PROF_COUNT, 3, row);
+}
+
+// Once per frame, at the end of game_frame() after its ticks: count missed
+// VBlanks and report each full window through the debug channel and overlay
+void profile_frame() {
+    uint16_t now = sys_time;
+    uint16_t elapsed = now - prof.last_vbl;
+    prof.last_vbl = now;
+    if(elapsed > 1) {
+        prof.missed_vblanks += elapsed - 1;
+    }
+
+    if(++prof.frames < (1 << PROFILE_WINDOW_SHIFT)) return;
+
+    for(uint8_t i = 0; i < PROF_COUNT; i++) {
+        struct ProfileStat *stat = &prof.stat[i];
+        EMU_printf("PROF %s min=%hu avg=%u max=%hu",
+                   profile_names[i], stat->min,
+                   profile_avg(stat), stat->max);
+    }
+    EMU_printf("PROF mode=%s clocks/line=%u", cgb ? "CGB-2x" : "DMG", cgb ? 912 : 456);
+    EMU_printf("PROF missed=%u", prof.missed_vblanks);
+    EMU_printf("PROF isr=%u max=%u catchup=%u skipped=%u",
+               (uint16_t)frame_clock.isr_cost << ISR_TIMER_SHIFT,
+               (uint16_t)frame_clock.isr_max << ISR_TIMER_SHIFT,
+               frame_clock.catchup, frame_clock.skipped);
+    frame_clock.isr_max = 0;
+    EMU_printf("PROF raster=%u max=%u irqs=%u",
+               raster.frame_cost << ISR_TIMER_SHIFT, raster.cost_max << ISR_TIMER_SHIFT,
+               raster.frame_irqs);
+    raster.cost_max = 0;
+
+    if(prof.overlay) {
+        profile_draw_overlay();
+    }
+    profile_reset();
+}
+#endif
+
+void sprites_init() {
+    memset(&sprites, 0, sizeof(sprites));
+    sprites.load_hist[0] = SCREEN_LINES;
+    sprites.remap = 1;
+}
+
+void vsprite_mark(uint8_t id) {
+    struct VSprite *v = &sprites.vs[id];
+    if(!v->dirty) {
+        v->dirty = 1;
+        sprites.dirty_list[sprites.dirty_count++] = id;
+    }
+}
+
+// Add (delta 1) or remove (delta 0) a sprite at OAM y from the scanline loads
+void line_load_update(uint8_t y, uint8_t add) {
+    if(y < 9 || y >= 160) return;  // Hidden or entirely above the screen
+
+    uint8_t line = y > 16 ? y - 16 : 0;
+    uint8_t end = y - 8;
+    if(end > SCREEN_LINES) end = SCREEN_LINES;
+
+    sprites.visible += add ? 1 : -1;
+    for(; line < end; line++) {
+        uint8_t n = sprites.line_load[line];
+        sprites.load_hist[n]--;
+        if(add) {
+            n++;
+            if(n > sprites.peak) sprites.peak = n;
+        } else {
+            n--;
+        }
+        sprites.load_hist[n]++;
+        sprites.line_load[line] = n;
+    }
+
+    while(sprites.peak && !sprites.load_hist[sprites.peak]) {
+        sprites.peak--;
+    }
+}
+
+void vsprite_move(uint8_t id, uint8_t x, uint8_t y) {
+    struct VSprite *v = &sprites.vs[id];
+    if(v->y != y) {
+        uint8_t was_visible = sprites.visible;
+        line_load_update(v->y, 0);
+        v->y = y;
+        line_load_update(y, 1);
+        if(sprites.visible != was_visible || v->slot == NO_OAM_SLOT) {
+            sprites.remap = 1;
+        }
+        vsprite_mark(id);
+    }
+    if(v->x != x) {
+        v->x = x;
+        vsprite_mark(id);
+    }
+}
+
+void vsprite_tile(uint8_t id, uint8_t tile) {
+    if(sprites.vs[id].tile != tile) {
+        sprites.vs[id].tile = tile;
+        vsprite_mark(id);
+    }
+}
+
+void vsprite_prop(uint8_t id, uint8_t prop) {
+    if(sprites.vs[id].prop != prop) {
+        sprites.vs[id].prop = prop;
+        vsprite_mark(id);
+    }
+}
+
+// Copy a virtual sprite into its shadow OAM entry if the entry differs
+void oam_write(uint8_t slot, const struct VSprite *s) {
+    volatile OAM_item_t *oam = &shadow_OAM[slot];
+    if(oam->y != s->y || oam->x != s->x || oam->tile != s->tile || oam->prop != s->prop) {
+        oam->y = s->y;
+        oam->x = s->x;
+        oam->tile = s->tile;
+        oam->prop = s->prop;
+        sprites.oam_dirty++;
+    }
+}
+
+// Assign OAM slots to the visible virtual sprites. While any scanline holds
+// more than the hardware draws (or there are more sprites than OAM slots),
+// the starting sprite rotates every frame so the dropped ones take turns.
+// Writes only go to shadow OAM entries that changed, and the OAM DMA in the
+// VBlank handler is skipped on frames where none did.
+void update_sprites() {
+    uint8_t rotate = 0;
+    uint8_t overloaded = 0;
+    uint8_t worst = 0;                // Busiest scanline when overloaded
+    uint8_t owed = !_shadow_OAM_OFF;  // Last update's changes not copied yet
+
+    // Keep a VBlank that lands mid-update from copying a half written table
+    DISABLE_OAM_DMA;
+    sprites.oam_dirty = 0;
+
+    // Start past the sprites that got in last time, so the ones left out
+    // come first and every sprite is back within a frame or two
+    if(sprites.peak > SPRITES_PER_LINE || sprites.visible > OAM_COUNT) {
+        overloaded = 1;
+        rotate = sprites.rotate_next;
+        while(worst < SCREEN_LINES - 1 && sprites.line_load[worst] != sprites.peak) worst++;
+    }
+    if(sprites.peak > sprites.peak_max) {
+        sprites.peak_max = sprites.peak;
+    }
+
+    if(sprites.remap || rotate != sprites.rotate) {
+        // Slot assignment changed, walk every virtual sprite
+        uint8_t slot = 0;
+        uint8_t v = rotate;
+        uint8_t on_worst = 0;
+        uint8_t next = NO_OAM_SLOT;
+
+        for(uint8_t i = 0; i < VSPRITE_COUNT; i++) {
+            struct VSprite *s = &sprites.vs[v];
+            s->slot = NO_OAM_SLOT;
+            if(s->y >= 9 && s->y < 160) {
+                if(slot < OAM_COUNT) {
+                    s->slot = slot;
+                    oam_write(slot++, s);
+                }
+                // The hardware shows the first SPRITES_PER_LINE on a line in
+                // OAM order; note the first one past that, or past OAM
+                if(next == NO_OAM_SLOT && overloaded &&
+                   (s->slot == NO_OAM_SLOT ||
+                    ((uint8_t)(worst + 16 - s->y) < 8 && ++on_worst > SPRITES_PER_LINE))) {
+                    next = v;
+                }
+            }
+            s->dirty = 0;
+            if(++v == VSPRITE_COUNT) v = 0;
+        }
+        if(next != NO_OAM_SLOT) sprites.rotate_next = next;
+        sprites.dropped = sprites.visible - slot;
+
+        // Hide the slots nobody claimed
+        for(; slot < OAM_COUNT; slot++) {
+            if(shadow_OAM[slot].y) {
+                shadow_OAM[slot].y = 0;
+                sprites.oam_dirty++;
+            }
+        }
+
+        sprites.rotate = rotate;
+        sprites.remap = 0;
+    } else {
+        // Same slots as last frame, only the changed sprites need copying
+        for(uint8_t i = 0; i < sprites.dirty_count; i++) {
+            struct VSprite *s = &sprites.vs[sprites.dirty_list[i]];
+            if(s->slot != NO_OAM_SLOT) {
+                oam_write(s->slot, s);
+            }
+            s->dirty = 0;
+        }
+    }
+    sprites.dirty_count = 0;
+
+    if(sprites.oam_dirty || owed) {
+        ENABLE_OAM_DMA;
+    }
+}
+
+// Animation handlers
+// Draw a frame with its first part on virtual sprite first. Parts go through
+// the vsprite setters, so only OAM entries that actually change get rewritten,
+// and the whole call returns early when frame and position are both unchanged.
+void metasprite_draw(struct Metasprite *m, uint8_t first, const struct MetaFrame *frame, uint8_t x, uint8_t y) {
+    const struct MetaFrame *old = m->frame;
+    if(frame == old && x == m->x && y == m->y) return;
+
+    const struct MetaPart *part = frame->parts;
+    uint8_t id = first;
+    for(uint8_t i = frame->count; i; i--, part++, id++) {
+        if(frame != old) {
+            vsprite_tile(id, part->tile);
+            vsprite_prop(id, part->prop);
+        }
+        vsprite_move(id, x + part->dx, y + part->dy);
+    }
+
+    // Hide parts the previous frame used that this one doesn't
+    if(old) {
+        for(uint8_t i = frame->count; i < old->count; i++) {
+            vsprite_move(first + i, 0, 0);
+        }
+    }
+
+    m->frame = frame;
+    m->x = x;
+    m->y = y;
+}
+
+void metasprite_hide(struct Metasprite *m, uint8_t first) {
+    if(!m->frame) return;
+    for(uint8_t i = 0; i < m->frame->count; i++) {
+        vsprite_move(first + i, 0, 0);
+    }
+    m->frame = NULL;
+}
+
+// Player poses (standing, casting, reeling), each facing right then left.
+// Sprites sit 3 pixels above player_y. Tiles come from player.png, 4 per pose.
+#define PLAYER_PARTS(t, flip) { 4, { \
+    { 0, -3, (t) + ((flip) ? 1 : 0), OBJ_PAL_PLAYER | (flip) }, \
+    { 8, -3, (t) + ((flip) ? 0 : 1), OBJ_PAL_PLAYER | (flip) }, \
+    { 0,  5, (t) + ((flip) ? 3 : 2), OBJ_PAL_PLAYER | (flip) }, \
+    { 8,  5, (t) + ((flip) ? 2 : 3), OBJ_PAL_PLAYER | (flip) } } }
+
+const struct MetaFrame player_frames[] = {
+    PLAYER_PARTS(0, 0), PLAYER_PARTS(0, S_FLIPX),   // Standing
+    PLAYER_PARTS(4, 0), PLAYER_PARTS(4, S_FLIPX),   // Casting
+    PLAYER_PARTS(8, 0), PLAYER_PARTS(8, S_FLIPX),   // Reeling
+};
+
+// Bobber, splash and bite, indexed by lure_state
+const struct MetaFrame lure_frames[LURE_FRAMES] = {
+    { 1, { { 0, 0, 13, OBJ_PAL_TACKLE } } },
+    { 1, { { 0, 0, 14, OBJ_PAL_TACKLE } } },
+    { 1, { { 0, 0, 15, OBJ_PAL_TACKLE } } },
+};
+
+void draw_player() {
+    metasprite_draw(&game.player_sprite, PLAYER_SPRITE,
+                    &player_frames[PLAYER_FRAME(game.player_state, game.facing_right)],
+                    game.player_x, game.player_y);
+}
+
+void init_sprites() {
+   sprites_init();
+
+   // Load all sprite data
+   asset_load(&player_asset, 0, ASSET_SPRITE);              // Player sprites (3 poses x 4 tiles)
+   asset_load(&sprites_asset, PLAYER_TILES, ASSET_SPRITE);  // Fishing line, bobber, and fish
+
+   // Initialize line segment sprites
+   for(uint8_t i = 0; i < MAX_LINE_SEGMENTS; i++) {
+       vsprite_tile(LINE_SPRITE + i, 12); // Line tile
+       vsprite_prop(LINE_SPRITE + i, OBJ_PAL_TACKLE);
+       game.line[i].sprite_id = LINE_SPRITE + i;
+   }
+}
+
+void band_link(uint8_t i) {
+    struct FishPool *pool = &game.fish;
+    uint8_t b = pool->y[i] >> FISH_BAND_SHIFT;
+    uint8_t head = pool->band_head[b];
+
+    pool->band[i] = b;
+    pool->band_prev[i] = NO_FISH;
+    pool->band_next[i] = head;
+    if(head != NO_FISH) pool->band_prev[head] = i;
+    pool->band_head[b] = i;
+}
+
+void band_unlink(uint8_t i) {
+    struct FishPool *pool = &game.fish;
+    uint8_t prev = pool->band_prev[i];
+    uint8_t next = pool->band_next[i];
+
+    if(prev != NO_FISH) {
+        pool->band_next[prev] = next;
+    } else {
+        pool->band_head[pool->band[i]] = next;
+    }
+    if(next != NO_FISH) pool->band_prev[next] = prev;
+}
+
+// Move a fish vertically, re-bucketing it only when it crosses a band edge
+void set_fish_y(uint8_t i, uint8_t y) {
+    struct FishPool *pool = &game.fish;
+    pool->y[i] = y;
+    if((y >> FISH_BAND_SHIFT) != pool->band[i]) {
+        band_unlink(i);
+        band_link(i);
+    }
+}
+
+// Take a free slot and start a new fish swimming in from one side
+void spawn_fish() {
+    struct FishPool *pool = &game.fish;
+    if(!pool->free_count) return;
+
+    uint8_t i = pool->free[--pool->free_count];
+    pool->active_pos[i] = pool->active_count;
+    pool->active[pool->active_count++] = i;
+
+    // One roll covers the whole fish: depth from the low byte, type from
+    // the top six bits, direction and speed from the two below them
+    uint16_t r = rng_next();
+
+    pool->hooked[i] = 0;
+    pool->interested[i] = 0;
+    pool->direction[i] = (r >> 8) & 1;
+    pool->x[i] = pool->direction[i] ? 30 : 130;
+    pool->y[i] = WATER_LINE + 10 + RNG_RANGE(r, 30);
+    pool->type[i] = RNG_RANGE((r >> 8) & 0xFC, 3);
+    band_link(i);
+    pool->move_timer[i] = 2 + pool->type[i];
+    
+    // More varied and slower speeds
+    // Base speed of 0.5 to 1 (we'll only move every other frame or so)
+    pool->speed[i] = ((r >> 9) & 1) + 1;  // 1 or 2
+    
+    // Bigger fish move a bit slower
+    if(pool->type[i] > 0) {
+        pool->speed[i] = 1;  // Medium and large fish always move slower
+    }
+
+    vsprite_tile(FISH_SPRITE + i, 16 + pool->type[i]); // Fish tile for this size
+    vsprite_prop(FISH_SPRITE + i, OBJ_PAL_FISH + pool->type[i]);
+    vsprite_move(FISH_SPRITE + i, pool->x[i], pool->y[i]);
+}
+
+// Return a fish's slot to the free stack and hide its sprite
+void despawn_fish(uint8_t i) {
+    struct FishPool *pool = &game.fish;
+    uint8_t pos = pool->active_pos[i];
+    uint8_t last = pool->active[--pool->active_count];
+
+    pool->active[pos] = last;
+    pool->active_pos[last] = pos;
+    pool->free[pool->free_count++] = i;
+    pool->hooked[i] = 0;
+    pool->interested[i] = 0;
+    band_unlink(i);
+
+    vsprite_move(FISH_SPRITE + i, 0, 0);
+}
+
+// Give the first free-swimming fish near the resting lure an interest in it.
+// Only the bands within FISH_INTEREST_RADIUS of the lure are searched.
+void find_interested_fish() {
+    struct FishPool *pool = &game.fish;
+    uint8_t lure_x = game.lure_x;
+    uint8_t lure_y = game.lure_y;
+    uint8_t top = lure_y > FISH_INTEREST_RADIUS ? lure_y - (FISH_INTEREST_RADIUS - 1) : 0;
+    uint8_t bottom = lure_y < 256 - FISH_INTEREST_RADIUS ? lure_y + (FISH_INTEREST_RADIUS - 1) : 255;
+
+    for(uint8_t b = top >> FISH_BAND_SHIFT; b <= (bottom >> FISH_BAND_SHIFT); b++) {
+        for(uint8_t i = pool->band_head[b]; i != NO_FISH; i = pool->band_next[i]) {
+            if(!pool->hooked[i] &&
+               ABS_DIFF(pool->x[i], lure_x) < FISH_INTEREST_RADIUS &&
+               ABS_DIFF(pool->y[i], lure_y) < FISH_INTEREST_RADIUS) {
+                pool->interested[i] = 1;
+                game.fish_interested = 1;
+                return;
+            }
+        }
+    }
+}
+
+void handle_fish() {
+    struct FishPool *pool = &game.fish;
+    uint8_t drifter = NO_FISH;
+
+    // Drift visits one slot per due tick, so no two fish drift on the same one
+    if(TASK_DUE(TASK_DRIFT)) {
+        drifter = pool->drift_next;
+        if(++pool->drift_next == FISH_POOL_SIZE) pool->drift_next = 0;
+    }
+
+    if(!game.fish_interested && game.cast_phase == 2) {
+        find_interested_fish();
+    }
+
+    // Walk the active list backwards so an escaping fish can be swapped out
+    for(uint8_t n = pool->active_count; n--; ) {
+        uint8_t i = pool->active[n];
+        uint8_t x = pool->x[i];
+        uint8_t y = pool->y[i];
+        
+		if(pool->hooked[i]) {
+            // Hooked fish behavior
+			if(game.is_reeling) {
+				x = game.lure_x;
+				y = game.lure_y;
+			} else {
+				if(TASK_DUE(TASK_WIGGLE)) {
+					// Both nudges and the escape check share one roll
+					uint16_t r = rng_next();
+					x += RNG_JITTER(r);
+					y += RNG_JITTER(r >> 4);
+					
+					// This is where the escape check goes
+					if((uint8_t)(r >> 8) < FISH_ESCAPE_ODDS) {
+						despawn_fish(i);
+						game.fish_interested = 0;
+						continue;
+					}
+				}
+			}
+		} else if(pool->interested[i]) {
+			// Distance to lure, before this frame's approach
+			uint8_t dx = ABS_DIFF(x, game.lure_x);
+			uint8_t dy = ABS_DIFF(y, game.lure_y);
+			
+			// Slow approach to lure
+			if(x < game.lure_x) x++;
+			if(x > game.lure_x) x--;
+			if(y < game.lure_y) y++;
+			if(y > game.lure_y) y--;
+			
+			// Lost interest if too far from lure
+			if(dx > FISH_INTEREST_RADIUS + 10 || dy > FISH_INTEREST_RADIUS + 10) {
+				pool->interested[i] = 0;
+				game.fish_interested = 0;
+			}
+			
+			// Check if close enough to bite and player is reeling
+			if(dx < 16 && dy < 16 && game.is_reeling) {
+				pool->hooked[i] = 1;
+				pool->interested[i] = 0;
+				add_score(&bite_points);
+			}
+		} else {
+			// Normal swimming behavior
+			if(!--pool->move_timer[i]) {
+				pool->move_timer[i] = 2 + pool->type[i];
+				uint8_t next_x = x + (pool->direction[i] ? pool->speed[i] : -pool->speed[i]);
+				
+				if(next_x < 16 || next_x > 152) {
+					pool->direction[i] = !pool->direction[i];
+					x += (pool->direction[i] ? 4 : -4);
+				} else {
+					x = next_x;
+				}
+			}
+			
+			if(i == drifter) {
+				int8_t y_move = RNG_JITTER(rng_next());
+				if(y + y_move >= WATER_LINE + 10 && 
+				   y + y_move <= WATER_LINE + 50) {
+					y += y_move;
+				}
+			}
+		}
+        
+        pool->x[i] = x;
+        if(y != pool->y[i]) {
+            set_fish_y(i, y);
+        }
+        vsprite_move(FISH_SPRITE + i, x, y);
+    }
+
+    // One roll for all fish short of the target, with the same odds as
+    // rolling each one
+    if(pool->active_count < FISH_TARGET &&
+       RNG_RANGE(rng_next(), FISH_SPAWN_ODDS) < (uint8_t)(FISH_TARGET - pool->active_count)) {
+        spawn_fish();
+    }
+}
+
+void line_axis_init(struct LineAxis *a, uint8_t from, uint8_t to) {
+    uint8_t d = to >= from ? to - from : from - to;
+    
+    // d / LINE_SPANS by reciprocal multiply. The estimate is never low and at
+    // most one too high, which shows up as a negative remainder.
+    uint8_t q = ((uint16_t)d * LINE_RECIP) >> 8;
+    int16_t r = (int16_t)d - (int16_t)q * LINE_SPANS;
+    if(r < 0) {
+        q--;
+        r += LINE_SPANS;
+    }
+    
+    a->pos = from;
+    a->q = q;
+    a->r = r;
+    a->err = 0;
+    a->negative = to < from;
+}
+
+void line_axis_step(struct LineAxis *a) {
+    uint8_t step = a->q;
+    
+    a->err += a->r;
+    if(a->err >= LINE_SPANS) {
+        a->err -= LINE_SPANS;
+        step++;
+    }
+    a->pos = a->negative ? a->pos - step : a->pos + step;
+}
+
+void update_line() {
+   if(game.is_casting) {
+        uint8_t start_x = game.player_x + (game.facing_right ? 12 : -4);
+        uint8_t start_y = game.player_y + 4;
+        
+        struct LineAxis ax, ay;
+        int16_t sag = 0;       // Sag offset (8.8)
+        int16_t sag_step = 0;  // Change in sag to the next segment
+        int16_t sag_k = 0;
+        
+        line_axis_init(&ax, start_x, game.lure_x);
+        line_axis_init(&ay, start_y, game.lure_y);
+        
+        if(game.cast_phase == 2 && !game.is_reeling) {
+            // Slack line in the water sags in a parabola, k * i * (spans - i),
+            // deeper the further out the lure is. Walked by forward differences.
+            uint8_t depth = ((uint16_t)ax.q * LINE_SPANS) >> 4;
+            if(depth > LINE_SAG_MAX) depth = LINE_SAG_MAX;
+            sag_k = depth * LINE_SAG_K;
+            sag_step = sag_k * (LINE_SPANS - 1);
+        }
+        
+        // Calculate line segment positions
+        for(uint8_t i = 0; i < MAX_LINE_SEGMENTS; i++) {
+            struct LineSegment *seg = &game.line[i];
+            
+            seg->x = ax.pos;
+            seg->y = ay.pos + (uint8_t)((uint16_t)(sag + 0x80) >> 8);
+            
+            vsprite_move(seg->sprite_id, seg->x, seg->y);
+            seg->active = 1;
+            
+            line_axis_step(&ax);
+            line_axis_step(&ay);
+            sag += sag_step;
+            sag_step -= sag_k << 1;
+        }
+    } else {
+       // Hide line segments
+       for(uint8_t i = 0; i < MAX_LINE_SEGMENTS; i++) {
+           vsprite_move(game.line[i].sprite_id, 0, 0);
+           game.line[i].active = 0;
+       }
+   }
+}
+
+// Place the lure on a whole pixel
+void set_lure(uint8_t x, uint8_t y) {
+   game.lure_fx = FIX(x);
+   game.lure_fy = FIX(y);
+   game.lure_x = x;
+   game.lure_y = y;
+}
+
+void update_lure() {
+   uint16_t next;  // Declare at start of function
+   
+   if(game.is_casting) {
+       switch(game.cast_phase) {
+           case 0: // Starting cast
+               set_lure(game.player_x + (game.facing_right ? 12 : -4), game.player_y + 4);
+               break;
+               
+           case 1: // Flying through air
+               next = game.lure_fx + game.lure_vel_x;
+               
+               // Screen boundary checks (a wrap past zero shows up as next moving the wrong way)
+               if(game.lure_vel_x < 0 && (next > game.lure_fx || next < FIX(8))) {
+                   game.lure_fx = FIX(8);
+                   game.lure_vel_x = 0;
+               } else if(game.lure_vel_x > 0 && (next < game.lure_fx || next > FIX(160))) {
+                   game.lure_fx = FIX(160);
+                   game.lure_vel_x = 0;
+               } else {
+                   game.lure_fx = next;
+               }
+               
+               next = game.lure_fy + game.lure_vel_y;
+               if(game.lure_vel_y < 0 && next > game.lure_fy) {
+                   game.lure_fy = 0;
+                   game.lure_vel_y = 0;
+               } else {
+                   game.lure_fy = next;
+               }
+               
+               game.lure_vel_y += GRAVITY;
+               
+               if(game.lure_fy >= FIX(WATER_LINE)) {
+                   game.lure_fy = FIX(WATER_LINE);
+                   game.lure_vel_y = 0;
+                   game.lure_vel_x = 0;
+                   game.cast_phase = 2;
+                   game.splash_timer = 30;
+                   game.lure_state = 1; // Just splash animation
+               }
+               break;
+               
+           case 2: // In water
+               if(!game.is_reeling) {
+                   // Add slow sinking when not reeling
+                   if(game.lure_fy < FIX(WATER_LINE + 50)) {
+                       game.lure_fy += SINK_SPEED;
+                   }
+               }
+               
+               // Update splash animation
+               if(game.splash_timer) {
+                   game.splash_timer--;
+                   if(!game.splash_timer) {
+                       game.lure_state = 0; // Normal bobber
+                   }
+               }
+               break;
+       }
+       
+       game.lure_x = FIX_PX(game.lure_fx);
+       game.lure_y = FIX_PX(game.lure_fy);
+       metasprite_draw(&game.lure_sprite, LURE_SPRITE, &lure_frames[game.lure_state],
+                       game.lure_x, game.lure_y);
+   } else {
+       metasprite_hide(&game.lure_sprite, LURE_SPRITE);
+   }
+}
+
+void start_cast() {
+   game.is_casting = 1;
+   game.cast_phase = 1;
+   game.player_state = 1;
+   
+   // Launch speed follows the fine charge, so every charge level is its own arc
+   int16_t speed = (int16_t)game.cast_charge << CAST_VEL_SHIFT;
+   game.lure_vel_x = game.facing_right ? speed : -speed;
+   game.lure_vel_y = -speed;
+   
+   set_lure(game.player_x + (game.facing_right ? 12 : -4), game.player_y + 4);
+   game.lure_state = 0;
+}
+
+// Move one lure axis toward a pixel target by at most the reel speed
+void reel_axis(uint16_t *pos, uint8_t target) {
+    uint16_t goal = FIX(target);
+    uint16_t step = game.reel_speed;
+
+    if(*pos < goal) {
+        *pos = (goal - *pos > step) ? *pos + step : goal;
+    } else if(*pos > goal) {
+        *pos = (*pos - goal > step) ? *pos - step : goal;
+    }
+}
+
+void handle_catch() {
+    if(game.is_reeling) {
+        // Calculate direction to player
+        int16_t target_x = game.player_x + (game.facing_right ? 12 : -4);
+        int16_t target_y = game.player_y + 4;
+        
+        int16_t dx = target_x - game.lure_x;
+        int16_t dy = target_y - game.lure_y;
+        
+        int16_t abs_dx = dx > 0 ? dx : -dx;
+        int16_t abs_dy = dy > 0 ? dy : -dy;
+        int16_t manhattan_dist = abs_dx + abs_dy;
+        
+        if(manhattan_dist < 8) {  // Close enough to player
+			// Reset fishing states
+			game.is_casting = 0;
+			game.is_reeling = 0;
+			game.cast_phase = 0;
+			game.player_state = 0;
+			
+			// Handle only the hooked fish
+			for(uint8_t n = 0; n < game.fish.active_count; n++) {
+				uint8_t i = game.fish.active[n];
+				if(game.fish.hooked[i]) {
+					// Add to score based on fish type
+					add_score(&catch_points[game.fish.type[i]]);
+					game.fish_caught++;
+					if(game.fish.type[i] > game.largest_fish) {
+						game.largest_fish = game.fish.type[i];
+					}
+					
+					// Replace the caught fish with a new one
+					despawn_fish(i);
+					spawn_fish();
+					
+					break;  // We found and handled the hooked fish, no need to continue
+				}
+			}
+			
+			game.fish_interested = 0;  // Reset the interest flag
+			
+			// Hide bobber and line
+			metasprite_hide(&game.lure_sprite, LURE_SPRITE);
+			for(uint8_t i = 0; i < MAX_LINE_SEGMENTS; i++) {
+				vsprite_move(game.line[i].sprite_id, 0, 0);
+			}
+		} else {
+            // Continue reeling in motion
+            if(abs_dx > abs_dy) {
+                reel_axis(&game.lure_fx, target_x);
+                
+                if(manhattan_dist > 16) {
+                    reel_axis(&game.lure_fy, target_y);
+                }
+            } else {
+                reel_axis(&game.lure_fy, target_y);
+                
+                if(manhattan_dist > 16) {
+                    reel_axis(&game.lure_fx, target_x);
+                }
+            }
+            
+            game.lure_x = FIX_PX(game.lure_fx);
+            game.lure_y = FIX_PX(game.lure_fy);
+        }
+    }
+}
+
+// Power bar on the HUD, redrawn only when the number of filled segments
+// changes. Blank while not charging.
+void update_power_meter() {
+    uint8_t tiles[METER_SEGMENTS];
+    uint8_t charging = game.cast_charge > 0;
+
+    // Round up, so the first charge frame shows a segment and 255 fills the bar
+    uint8_t filled = ((uint16_t)game.cast_charge * METER_SEGMENTS + 255) >> 8;
+    if(filled == game.meter) return;
+    game.meter = filled;
+
+    for(uint8_t i = 0; i < METER_SEGMENTS; i++) {
+        if(!charging) {
+            tiles[i] = FONT_TILE_BLANK;
+        } else if(i < filled) {
+            tiles[i] = METER_TILE_FULL;
+        } else {
+            tiles[i] = METER_TILE_EMPTY;
+        }
+    }
+    vram_queue_row(HUD_METER_X, HUD_ROW, METER_SEGMENTS, tiles);
+}
+
+// Bind the score HUD to a counter. The SCORE: label is part of the map and
+// the digits follow it; y is a queue row, so it picks the map as well.
+void attach_score(uint8_t x, uint8_t y, const BCD *value) {
+    game.score_hud.x = x + 6;
+    game.score_hud.y = y;
+    game.score_hud.value = value;
+    game.score_hud.dirty = 1;
+    memset(game.score_hud.tiles, 0xFF, SCORE_DIGITS);  // Force a full redraw
+}
+
+void add_score(const BCD *points) {
+    bcd_add(&game.score, points);
+    game.score_hud.dirty = 1;
+}
+
+// Queue only the span of digit tiles that changed
+void draw_score() {
+    struct ScoreHud *hud = &game.score_hud;
+    uint8_t text[9];
+    uint8_t first = SCORE_DIGITS;
+    uint8_t last = 0;
+
+    if(!hud->dirty || !hud->value) return;
+    hud->dirty = 0;
+
+    bcd2text(hud->value, FONT_TILE_DIGIT0, text);
+    for(uint8_t i = 0; i < SCORE_DIGITS; i++) {
+        uint8_t tile = text[8 - SCORE_DIGITS + i];
+        if(hud->tiles[i] != tile) {
+            hud->tiles[i] = tile;
+            if(first == SCORE_DIGITS) first = i;
+            last = i;
+        }
+    }
+
+    if(first < SCORE_DIGITS) {
+        vram_queue_row(hud->x + first, hud->y, last - first + 1, &hud->tiles[first]);
+    }
+}
+
+void update_input() {
+    game.prev_input = game.curr_input;
+    game.curr_input = joypad();
+#ifdef INPUT_LOG
+    game.curr_input = input_log_next(game.curr_input);
+#endif
+    game.pressed = (game.curr_input ^ game.prev_input) & game.curr_input;
+}
+
+void handle_input() {
+    switch(game.state) {
+        case STATE_TITLE:
+            if(game.pressed & J_START) {
+                game.state = STATE_PLAYING;
+                game.is_transition = 1;  // Set transition flag
+                display_gameplay();
+            }
+            break;
+            
+        case STATE_PLAYING:
+            if(!game.is_casting && !game.is_reeling) {  // Not casting or reeling - can move and cast
+                // Movement controls
+                if(game.curr_input & J_LEFT && game.player_x > MIN_PLAYER_X) {
+					game.player_x--;
+					game.facing_right = 0;
+				}
+				if(game.curr_input & J_RIGHT && game.player_x < PIER_END_X) {  // Changed this line
+					game.player_x++;
+					game.facing_right = 1;
+				}
+							
+                // Casting charge-up
+                if(game.curr_input & J_A) {
+					if(game.cast_charge < 255 - CAST_CHARGE_RATE) {
+						game.cast_charge += CAST_CHARGE_RATE;
+					} else {
+						game.cast_charge = 255;
+					}
+					game.cast_power = game.cast_charge >> CAST_POWER_SHIFT;
+					if(game.cast_power >= MIN_CAST_POWER) {
+						game.player_state = 1;  // Only pose once a release would cast
+					}
+				} else if(game.cast_charge > 0) {
+					if(game.cast_power >= MIN_CAST_POWER) {
+						start_cast();
+					}
+					game.cast_charge = 0;
+					game.cast_power = 0;
+				}
+            } else if(game.is_casting) {  // Line is out
+                if(game.curr_input & J_B) {  // While holding B
+                    game.is_reeling = 1;
+                    game.player_state = 2;  // Reeling animation
+                } else {
+                    game.is_reeling = 0;
+                    if(game.cast_phase == 2) {  // If line is in water
+                        game.player_state = 0;  // Back to standing
+                    }
+                }
+            }
+#ifdef PROFILE
+			if(game.pressed & J_SELECT) {
+				// Toggle the profiler overlay; the background is redrawn when it closes
+				prof.overlay = !prof.overlay;
+				if(!prof.overlay) {
+					restore_rows(GAME_ROW, 7, PROF_COUNT + 1);
+				}
+			}
+#endif
+			if(game.pressed & J_START) {
+				game.state = STATE_PAUSE;
+				game.is_transition = 1;
+				display_pause();
+			}
+            break;
+            
+        case STATE_PAUSE:
+            if((game.pressed & J_START) && !game.is_transition) {
+                game.state = STATE_PLAYING;
+                game.is_transition = 1;
+                remove_pause();
+            }
+            break;
+    }
+
+    // Clear transition flag when START is released
+    if(!(game.curr_input & J_START)) {
+        game.is_transition = 0;
+    }
+}
+
+// Update function to handle all regions
+void update_regions() {
+    PROFILE_BEGIN(PROF_REGIONS);
+    // Update all regions every frame
+    for(uint8_t i = 0; i < game.num_regions; i++) {
+        struct ScreenRegion* region = &game.regions[i];
+        if(region->update && (region->properties & REGION_PROP_ANIMATED)) {
+            region->update(region);
+        }
+    }
+    PROFILE_END(PROF_REGIONS);
+}
+
+void update_animated_region(struct ScreenRegion* region) {
+    struct TileAnimation *anim = region->animation;
+    if(!anim) return;
+    
+    if(!--anim->ticks_left) {
+        anim->ticks_left = anim->frame_delay;
+        anim->current_frame++;
+        if(anim->current_frame >= anim->num_frames) {
+            anim->current_frame = 0;
+        }
+
+        if(anim->mode == ANIM_MODE_PATTERN) {
+            // One pattern upload, however many cells show the tile
+            vram_queue_data(anim->target_tile, 1,
+                            anim->frame_data + ((uint16_t)anim->current_frame << 4));
+            return;
+        }
+        
+        uint8_t current_tile = anim->frame_tiles[anim->current_frame];
+
+        // Nothing is drawn over the BG, so whole rows are repainted
+        for(uint8_t y = region->y; y < region->y + region->height; y++) {
+            vram_queue_fill(region->x, vram.front + y, region->width, current_tile);
+        }
+    }
+}
+
+void add_region(uint8_t x, uint8_t y, uint8_t width, uint8_t height, 
+                uint8_t layer, uint8_t properties, 
+                uint8_t tile_start, uint8_t tile_count,
+                void (*update)(struct ScreenRegion*)) {
+    if(game.num_regions < MAX_REGIONS) {
+        struct ScreenRegion* region = &game.regions[game.num_regions++];
+        region->x = x;
+        region->y = y;
+        region->width = width;
+        region->height = height;
+        region->layer = layer;
+        region->properties = properties;
+        region->tile_start = tile_start;
+        region->tile_count = tile_count;
+        region->update = update;
+    }
+}
+
+void clear_regions() {
+    game.num_regions = 0;
+}
+
+void update_game() {
+    draw_player();
+    
+    if(game.is_casting || game.is_reeling) {  // Keep updating line and bobber while either casting or reeling
+        update_lure();
+        PROFILE_BEGIN(PROF_LINE);
+        update_line();
+        PROFILE_END(PROF_LINE);
+        if(game.is_reeling) {
+            handle_catch();  // Process reeling animation
+        }
+    }
+    
+    PROFILE_BEGIN(PROF_FISH);
+    handle_fish();
+    PROFILE_END(PROF_FISH);
+    PROFILE_BEGIN(PROF_METER);
+    update_power_meter();
+    PROFILE_END(PROF_METER);
+}
+
+void check_high_score() {
+   if(game.score > game.high_score) {
+       game.high_score = game.score;
+   }
+}
+
+static const uint8_t task_period[TASK_COUNT] = {
+    WIGGLE_PERIOD, DRIFT_PERIOD, CLOUDS_PERIOD, SHIMMER_PERIOD
+};
+static const uint8_t task_phase[TASK_COUNT] = {
+    WIGGLE_PHASE, DRIFT_PHASE, CLOUDS_PHASE, SHIMMER_PHASE
+};
+
+void sched_init() {
+    for(uint8_t i = 0; i < TASK_COUNT; i++) {
+        sched.left[i] = task_phase[i];
+    }
+    sched.due = 0;
+}
+
+// Count every task down and flag the ones that reach zero for this tick
+void sched_tick() {
+    uint8_t due = 0;
+
+    for(uint8_t i = 0; i < TASK_COUNT; i++) {
+        if(!--sched.left[i]) {
+            sched.left[i] = task_period[i];
+            due |= 1 << i;
+        }
+    }
+    sched.due = due;
+}
+
+// One fixed logic tick: input, then whatever the current state runs
+void game_tick() {
+    sched_tick();
+    PROFILE_BEGIN(PROF_INPUT);
+    update_input();
+    PROFILE_END(PROF_INPUT);
+    PROFILE_BEGIN(PROF_HANDLE_INPUT);
+    handle_input();
+    PROFILE_END(PROF_HANDLE_INPUT);
+    
+    switch(game.state) {
+        case STATE_TITLE:
+            update_regions();
+            break;
+            
+        case STATE_PLAYING:
+            PROFILE_BEGIN(PROF_GAME);
+            update_game();
+            PROFILE_END(PROF_GAME);
+            update_regions();
+            update_raster();
+            break;
+            
+        case STATE_PAUSE:
+            update_regions();
+            break;
+            
+        case STATE_CATCH:
+            update_game();
+            update_regions();
+            handle_catch();
+            game.state = STATE_PLAYING;
+            break;
+    }
+    
+    if(game.state == STATE_CATCH) {
+        check_high_score();
+    }
+}
+
+// Run a logic tick for every VBlank since the last call (more than one if
+// the last frame overran), then prepare what the next VBlank will show
+void game_frame() {
+    uint8_t ticks;
+
+    // Test and sleep with interrupts off, so a VBlank landing between the two
+    // wakes the HALT instead of being slept through for a whole frame
+    disable_interrupts();
+    while(!frame_clock.pending) {
+        WAIT_INTERRUPT();
+    }
+    ticks = frame_clock.pending;
+    frame_clock.pending = 0;
+    enable_interrupts();
+
+    if(ticks > MAX_TICKS_PER_FRAME) {
+        frame_clock.skipped += ticks - MAX_TICKS_PER_FRAME;
+        ticks = MAX_TICKS_PER_FRAME;
+    }
+    frame_clock.catchup += ticks - 1;
+    while(ticks--) {
+        game_tick();
+    }
+
+    PROFILE_BEGIN(PROF_SCORE);
+    draw_score();
+    PROFILE_END(PROF_SCORE);
+    PROFILE_BEGIN(PROF_SPRITES);
+    update_sprites();
+    PROFILE_END(PROF_SPRITES);
+#ifdef PROFILE
+    profile_frame();
+#endif
+}
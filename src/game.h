@@ -0,0 +1,636 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include <gb/gb.h>
+#include <gb/cgb.h>
+#include <gb/bcd.h>
+#include <string.h>
+#include <gbdk/font.h>
+#if defined(PROFILE) || defined(INPUT_LOG)
+#include <gbdk/emu_debug.h>
+#endif
+
+// Game states
+#define STATE_TITLE 0
+#define STATE_PLAYING 1
+#define STATE_PAUSE 2
+#define STATE_CATCH 3
+
+// Frame profiler (build with -DPROFILE). Times are in scanlines sampled from LY.
+#ifdef PROFILE
+#define PROF_INPUT 0         // update_input
+#define PROF_HANDLE_INPUT 1  // handle_input
+#define PROF_GAME 2          // update_game, including the three below
+#define PROF_FISH 3          // handle_fish
+#define PROF_LINE 4          // update_line
+#define PROF_METER 5         // update_power_meter
+#define PROF_SCORE 6         // draw_score
+#define PROF_REGIONS 7       // update_regions
+#define PROF_SPRITES 8       // update_sprites
+#define PROF_COUNT 9
+#define PROFILE_WINDOW_SHIFT 6  // Report every 64 frames
+#define PROFILE_BEGIN(id) prof.start[id] = LY_REG
+#define PROFILE_END(id) profile_end(id)
+#else
+#define PROFILE_BEGIN(id)
+#define PROFILE_END(id)
+#endif
+
+// Input log (build with -DINPUT_LOG and cartridge RAM). Every session is
+// recorded to SRAM; hold SELECT at power on to replay the saved one instead.
+#ifdef INPUT_LOG
+#define INPUT_LIVE 0
+#define INPUT_RECORD 1
+#define INPUT_REPLAY 2
+#define INPUT_LOG_MAGIC 0x4C49     // "IL"
+#define INPUT_LOG_RUNS ((uint16_t)((0x2000 - sizeof(struct InputLogHeader)) / sizeof(struct InputRun)))
+#endif
+
+// Frame timing. Logic runs in fixed ticks, one per VBlank; a frame that
+// overruns is made up with extra ticks, up to this many per frame.
+#define MAX_TICKS_PER_FRAME 3
+#define ISR_TIMER_SHIFT 4          // TIMA runs at 262144 Hz, one count per 16 clocks
+
+// Sleep until an interrupt, enabling them only for the HALT. EI takes effect
+// after the next instruction, so an interrupt already pending wakes the HALT
+// rather than being serviced before it. host/ supplies its own.
+#ifndef WAIT_INTERRUPT
+#define WAIT_INTERRUPT() __asm__("ei\n\thalt\n\tdi")
+#endif
+
+// Periodic tasks, counted down once per logic tick by sched_tick(). Each
+// starts at its own phase so tasks that share a tick are the exception.
+#define TASK_WIGGLE 0              // Hooked fish nudge and escape roll
+#define TASK_DRIFT 1               // Next fish in turn drifts up or down
+#define TASK_CLOUDS 2              // Cloud band scrolls a pixel
+#define TASK_SHIMMER 3             // Water shimmer moves one step along its wave
+#define TASK_COUNT 4
+#define WIGGLE_PERIOD 8
+#define WIGGLE_PHASE 1             // Odd ticks, clear of the drift task
+#define DRIFT_PERIOD 2             // Each fish drifts every DRIFT_PERIOD * FISH_POOL_SIZE ticks
+#define DRIFT_PHASE 2
+#define CLOUDS_PERIOD 16
+#define CLOUDS_PHASE 5             // 5 mod 16, never a wiggle or shimmer tick
+#define SHIMMER_PERIOD 4
+#define SHIMMER_PHASE 3            // 3 mod 4
+#define TASK_DUE(id) (sched.due & (1 << (id)))
+
+// Raster effects: the LCD (LYC) interrupt walks a table of scanlines and sets
+// SCX at each one. Handler time per frame is bounded by the table size.
+#define RASTER_MAX 32              // Table entries, so LCD interrupts per frame
+#define RASTER_LYC_OFF 0xFF        // LY never reaches it, so no interrupt
+#define CLOUD_TOP 16               // Cloud rows 2-3 scroll as one band
+#define CLOUD_BOTTOM 32
+#define SHIMMER_TOP 88             // First water line below the pier
+#define SHIMMER_STEP 2             // Lines per shimmer band, halving the interrupts
+#define SHIMMER_WAVE 16            // Entries in shimmer_wave[] (a power of two)
+
+// Virtual sprite slots, mapped onto OAM by the sprite allocator every frame
+#define PLAYER_SPRITE 0                              // 4 sprites, 16x16
+#define LINE_SPRITE 4                                // First line segment
+#define LURE_SPRITE (LINE_SPRITE + MAX_LINE_SEGMENTS)
+#define FISH_SPRITE (LURE_SPRITE + 1)                // One per fish pool slot
+#define VSPRITE_COUNT (FISH_SPRITE + FISH_POOL_SIZE)
+#define META_MAX_PARTS 4                             // Sprites in the largest metasprite frame
+#define PLAYER_FRAME(pose, right) ((pose) * 2 + !(right)) // player_frames[] index
+#define LURE_FRAMES 3                                // One per lure_state
+
+// Sprite hardware limits
+#define OAM_COUNT 40
+#define SPRITES_PER_LINE 10
+#define SCREEN_LINES 144
+#define NO_OAM_SLOT 0xFF
+
+// Screen positions
+#define WATER_LINE 85
+#define PIER_HEIGHT 75
+
+// Movement limits
+#define MIN_PLAYER_X 16
+#define MAX_PLAYER_X 144
+
+// Casting constants
+#define MAX_CAST_POWER 7
+#define MIN_CAST_POWER 1
+#define CAST_CHARGE_RATE 6   // Charge (0-255) gained per frame while holding A
+#define CAST_POWER_SHIFT 5   // cast_power = charge >> 5, 0 to MAX_CAST_POWER
+#define CAST_VEL_SHIFT 3     // Launch speed = charge << 3, just under 8 px/frame at full charge
+#define MAX_LINE_SEGMENTS 8  // Line sprites from rod tip to lure, at least 2
+#define LINE_SPANS (MAX_LINE_SEGMENTS - 1)
+#define LINE_RECIP ((256 + LINE_SPANS - 1) / LINE_SPANS)  // ceil(256 / spans)
+#define LINE_SAG_K ((4 * 256 + LINE_SPANS * LINE_SPANS / 2) / (LINE_SPANS * LINE_SPANS)) // 8.8 k per pixel of sag depth
+#define LINE_SAG_MAX 6       // Deepest sag of a slack line, in pixels
+
+// 8.8 fixed point: high byte is whole pixels, low byte is 1/256 of a pixel
+#define FIX(n) ((uint16_t)(n) << 8)
+#define FIX_PX(f) ((uint8_t)((uint16_t)(f) >> 8))
+#define GRAVITY 0x0100       // px/frame^2
+#define SINK_SPEED 0x0040    // px/frame while the lure drifts down
+#define REEL_SPEED FIX(1)    // Default reel speed, px/frame
+#define SCREEN_WIDTH 20
+#define SCREEN_HEIGHT 18
+#define MAX_REGIONS 8
+#define REGION_LAYER_BKG     0x01
+#define REGION_LAYER_WINDOW  0x02
+#define REGION_LAYER_SPRITE  0x04
+#define REGION_PROP_ANIMATED 0x10
+#define REGION_PROP_PERSIST  0x20
+#define REGION_PROP_PRIORITY 0x40
+#define REGION_PROP_TEXT 0x80
+#define PIER_END_X 48
+#define FISH_INTEREST_RADIUS 16
+#define FISH_POOL_SIZE 16    // Most fish in the pond at once (capacity)
+#define FISH_TARGET 3        // Fish the pond refills towards, at most FISH_POOL_SIZE
+#define FISH_SPAWN_ODDS 60   // Each missing fish spawns with 1 in 60 odds per frame
+#define FISH_ESCAPE_ODDS 5   // A hooked fish escapes with 5 in 256 odds per check (~2%)
+#define FISH_BAND_SHIFT 4    // Fish are bucketed by y into 16 pixel bands
+#define FISH_BANDS (256 >> FISH_BAND_SHIFT)
+#define NO_FISH 0xFF
+
+// Random numbers come from a 16-bit xorshift; see rng_next(). RNG_RANGE maps a
+// random byte onto 0..n-1 with a multiply and shift instead of a divide.
+#define RNG_SEED_DEFAULT 0xACE1  // xorshift never leaves zero, so seed 0 uses this
+#define RNG_RANGE(r, n) ((uint8_t)(((uint16_t)(uint8_t)(r) * (uint8_t)(n)) >> 8))
+
+// Absolute difference of two 8-bit values, without widening
+#define ABS_DIFF(a, b) ((a) > (b) ? (uint8_t)((a) - (b)) : (uint8_t)((b) - (a)))
+#define WATER_TILE 130       // Shared water tile, animated by pattern swaps
+
+// Tile animation modes
+#define ANIM_MODE_MAP 0      // Rewrite the region's map entries with frame_tiles
+#define ANIM_MODE_PATTERN 1  // Upload frame_data into the pattern of target_tile
+
+// Score HUD
+#define SCORE_DIGITS 5       // Digits shown after the "SCORE:" label
+#define FONT_TILE_BLANK 0    // font_min maps space (and ':') to tile 0
+#define FONT_TILE_DIGIT0 1   // followed by '0'-'9' at tiles 1-10
+#define FONT_TILE_ALPHA 11   // and 'A'-'Z' at tiles 11-36
+
+// VRAM write queue (drained by the VBlank handler)
+#define VRAM_QUEUE_SIZE 32     // Queued commands, must be a power of two
+// VRAM bytes per VBlank. The copy loops take about 10 M-cycles a byte and
+// each command about 60 more; VBlank is 1140, and OAM DMA, the GBDK handler
+// and the scroll and raster work take around half. Check any change with
+// `make emubench`: vram_blocked must stay 0.
+#define VRAM_BUDGET_BYTES 32
+#define VRAM_CMD_ROW 0         // Copy tiles from the arena into a BG map row
+#define VRAM_CMD_FILL 1        // Fill a BG map row span with one tile
+#define VRAM_CMD_DATA 2        // Copy 16-byte tile patterns into tile data
+#define VRAM_CMD_MAP 3         // Copy BG map tiles straight from ROM
+#define VRAM_CMD_LCDC 4        // Change LCDC bits, in order with the writes before it
+
+// Screen maps in ROM (maps.c), copied whole by load_screen()
+#define MAP_WIDTH 32
+#define MAP_SIZE (MAP_WIDTH * MAP_WIDTH)
+#define BKG_TILE_BASE 128      // background_asset is loaded from this tile
+
+// CGB palettes. DMG ignores the palette bits in OAM and never sees the
+// attribute maps, so these are set on both.
+#define BKG_PAL_SKY 0          // Sky, clouds, text and the HUD
+#define BKG_PAL_WATER 1
+#define BKG_PAL_PIER 2
+#define BKG_PAL_POST 3         // Pier posts stand in the water
+#define BKG_PAL_COUNT 4
+#define OBJ_PAL_PLAYER 0
+#define OBJ_PAL_TACKLE 1       // Line and lure
+#define OBJ_PAL_FISH 2         // Plus the fish type
+#define OBJ_PAL_COUNT 5
+#define HDMA_HBLANK 0x80       // HDMA5: 16 bytes per HBlank; reads set when done
+
+// Both BG maps are used. Queue rows count from 9800, so rows 32-63 are 9C00.
+#define TITLE_ROW 0            // Title screen in 9800
+#define GAME_ROW MAP_WIDTH     // Gameplay screen in 9C00
+
+// Window HUD along the bottom of the screen during play. The window shows
+// 9800 from row 0, which is free once the title is gone.
+#define HUD_ROW 0              // Queue row of the HUD (9800)
+#define HUD_WX 7
+#define HUD_WY (SCREEN_LINES - 8)
+#define HUD_SCORE_X 0          // "SCORE:" and the digits
+#define HUD_METER_X 12         // Power bar, or the pause banner
+#define METER_SEGMENTS 8
+#define METER_TILE_FULL 134
+#define METER_TILE_EMPTY 135
+#define METER_STALE 0xFF       // Forces the next update_power_meter() to draw
+
+// Fish pool, stored as parallel arrays indexed by slot. Live slots are kept
+// in a packed active list and free slots on a stack, so idle slots cost nothing.
+// A fish's sprite is FISH_SPRITE + slot.
+struct FishPool {
+    uint8_t x[FISH_POOL_SIZE];
+    uint8_t y[FISH_POOL_SIZE];
+    uint8_t type[FISH_POOL_SIZE];         // 0=small, 1=medium, 2=large
+    uint8_t direction[FISH_POOL_SIZE];    // 0=left, 1=right
+    uint8_t speed[FISH_POOL_SIZE];
+    uint8_t hooked[FISH_POOL_SIZE];       // Caught on the line
+    uint8_t interested[FISH_POOL_SIZE];   // Swimming toward the lure
+    uint8_t move_timer[FISH_POOL_SIZE];   // Ticks until the next swim step
+    uint8_t drift_next;                   // Slot the drift task visits next
+
+    uint8_t active[FISH_POOL_SIZE];       // Live slots, in no particular order
+    uint8_t active_pos[FISH_POOL_SIZE];   // Index of each live slot in active[]
+    uint8_t active_count;
+    uint8_t free[FISH_POOL_SIZE];         // Unused slots
+    uint8_t free_count;
+
+    // Live fish bucketed by y band, as doubly linked lists through the slots
+    uint8_t band_head[FISH_BANDS];
+    uint8_t band_next[FISH_POOL_SIZE];
+    uint8_t band_prev[FISH_POOL_SIZE];
+    uint8_t band[FISH_POOL_SIZE];         // Band each live fish is listed in
+};
+
+// Line segment structure
+struct LineSegment {
+    uint8_t x;
+    uint8_t y;
+    uint8_t active;
+    uint8_t sprite_id;
+};
+
+struct TileAnimation {
+    uint8_t num_frames;
+    uint8_t *frame_tiles;          // ANIM_MODE_MAP: tile index per frame
+    uint8_t current_frame;
+    uint8_t frame_delay;
+    uint8_t ticks_left;            // Counts down from frame_delay to the next frame
+    uint8_t mode;
+    uint8_t target_tile;           // ANIM_MODE_PATTERN: tile whose pattern is swapped
+    const uint8_t *frame_data;     // ANIM_MODE_PATTERN: 16 bytes per frame
+};
+
+// One axis of the rod-to-lure line, split into LINE_SPANS equal parts.
+// Each step adds q pixels plus a Bresenham carry from the remainder r.
+struct LineAxis {
+    uint8_t pos;
+    uint8_t q;
+    uint8_t r;
+    uint8_t err;
+    uint8_t negative;
+};
+
+// Update the ScreenRegion struct definition
+struct ScreenRegion {
+    uint8_t x, y, width, height;
+    uint8_t layer;
+    uint8_t properties;
+    uint8_t tile_start;
+    uint8_t tile_count;
+    struct TileAnimation *animation;
+    void (*update)(struct ScreenRegion*);
+};
+
+// Score counter drawn straight from packed BCD
+struct ScoreHud {
+    uint8_t x, y;                  // Map position of the first digit (queue row)
+    const BCD *value;              // Counter shown (score or high score)
+    uint8_t dirty;                 // Value changed since the last draw
+    uint8_t tiles[SCORE_DIGITS];   // Digit tiles currently on screen
+};
+
+// A sprite as entities see it; y below 9 or from 160 is off screen (as in OAM)
+struct VSprite {
+    uint8_t y, x, tile, prop;
+    uint8_t slot;    // OAM slot it was given, NO_OAM_SLOT if none
+    uint8_t dirty;   // Changed since the last update_sprites()
+};
+
+// One hardware sprite of a metasprite frame, placed relative to its origin
+struct MetaPart {
+    int8_t dx, dy;
+    uint8_t tile, prop;
+};
+
+// Metasprite frame in ROM. Mirrored poses are frames of their own with the
+// tiles already swapped and S_FLIPX set, so drawing never flips anything.
+struct MetaFrame {
+    uint8_t count;
+    struct MetaPart parts[META_MAX_PARTS];
+};
+
+// What a metasprite last drew, so an unchanged draw costs one compare.
+// A zeroed cache (frame NULL) draws in full next time.
+struct Metasprite {
+    const struct MetaFrame *frame;
+    uint8_t x, y;
+};
+
+// Shared between the main loop and the VBlank handler, which owns all
+// presentation: OAM DMA, the VRAM queue and the scroll registers.
+struct FrameClock {
+    volatile uint8_t pending;     // VBlanks not yet answered with a logic tick
+    uint8_t scx, scy;             // Scroll applied at the next VBlank
+    uint8_t isr_cost;             // Last handler run, in TIMA counts
+    uint8_t isr_max;              // Worst handler run since reset
+    uint16_t catchup;             // Extra ticks run for frames that overran
+    uint16_t skipped;             // VBlanks dropped past MAX_TICKS_PER_FRAME
+};
+
+struct Scheduler {
+    uint8_t left[TASK_COUNT];     // Ticks until each task is next due
+    uint8_t due;                  // TASK_DUE bits for the current tick
+};
+
+// One frame of raster changes: SCX becomes scx[i] from line[i] on. LYC is
+// armed at line[i] - 1 and the handler writes SCX in that line's HBlank.
+struct RasterTable {
+    uint8_t count;
+    uint8_t line[RASTER_MAX];      // Ascending, and none before line 1
+    uint8_t scx[RASTER_MAX];
+};
+
+// Built by game code into the back table, swapped in by the VBlank handler
+struct Raster {
+    struct RasterTable tables[2];
+    volatile uint8_t front;        // Table the LCD handler reads
+    volatile uint8_t ready;        // Back table is complete, swap at the next VBlank
+    uint8_t next;                  // Entry the next LYC match applies
+    uint8_t active;                // Effects on (gameplay screen shown)
+    uint8_t dirty;                 // Offsets changed since the last build
+    uint8_t cloud_x;
+    uint8_t phase;                 // Shimmer wave position of the top band
+    uint16_t cost;                 // LCD handler time so far this frame, in TIMA counts
+    uint16_t frame_cost;           // ... for the last whole frame
+    uint8_t frame_irqs;            // LCD interrupts taken in the last whole frame
+    uint16_t cost_max;             // Worst frame since reset
+};
+
+// Sprite allocator. Per-scanline load is kept up to date as sprites move,
+// along with a histogram of line loads so the peak is known without a scan.
+struct SpriteAllocator {
+    struct VSprite vs[VSPRITE_COUNT];
+    uint8_t line_load[SCREEN_LINES];      // Visible sprites on each scanline
+    uint8_t load_hist[VSPRITE_COUNT + 1]; // Scanlines at each load
+    uint8_t visible;                      // Visible virtual sprites
+    uint8_t peak;                         // Most sprites on one scanline right now
+    uint8_t peak_max;                     // Highest peak seen, for budgeting
+    uint8_t rotate;                       // First virtual sprite given an OAM slot
+    uint8_t rotate_next;                  // First sprite the last overloaded walk left hidden
+    uint8_t dropped;                      // Visible sprites that got no OAM slot
+
+    // Change tracking. Unchanged sprites cost nothing past the setter compare.
+    uint8_t dirty_list[VSPRITE_COUNT];    // Virtual sprites changed this frame
+    uint8_t dirty_count;
+    uint8_t remap;                        // Visibility changed, slots must be reassigned
+    uint8_t oam_dirty;                    // OAM entries rewritten in the last update
+};
+
+// One queued VRAM write. Rows and fills are split across VBlanks when they
+// don't fit the remaining budget, so x/len/src advance as they are drained.
+struct VramCmd {
+    uint8_t type;
+    uint8_t x, y;          // BG map position (ROW/FILL/MAP), y counted from 9800
+    uint8_t len;           // Tiles (ROW/FILL/MAP) or patterns (DATA) left to write
+    uint8_t tile;          // Fill tile (FILL), first pattern index (DATA) or LCDC bits (LCDC, x is the mask)
+    uint8_t src;           // Arena offset of the row tiles (ROW)
+    const uint8_t *data;   // Pattern data (DATA) or map tiles (MAP), must stay valid until flushed
+};
+
+// A compressed tile sheet, see tools/assets.py for the stream format. The
+// descriptor is in bank 0 and the stream in a switchable bank.
+#define ASSET_BKG 0
+#define ASSET_SPRITE 1
+#define ASSET_MIN_MATCH 3              // Shortest copy, added to the length field
+
+struct Asset {
+    const char *name;
+    uint8_t bank;                  // ROM bank holding data
+    uint8_t tiles;                 // Unpacked size in tiles
+    uint16_t packed;               // Compressed size in bytes
+    const uint8_t *data;
+};
+
+#include "assets.h"
+
+// Single-producer (game code) / single-consumer (VBlank handler) ring.
+// Row tiles are copied into a 256 byte arena so an 8-bit index wraps for free.
+struct VramQueue {
+    struct VramCmd cmds[VRAM_QUEUE_SIZE];
+    volatile uint8_t cmd_head;     // Next command to drain (VBlank handler)
+    volatile uint8_t cmd_tail;     // Next free command (game code)
+    uint8_t arena[256];
+    volatile uint8_t arena_head;   // First byte still in use (VBlank handler)
+    uint8_t arena_tail;            // Next free byte (game code)
+
+    // Counters, in VRAM bytes. Pending work is queued - flushed - discarded.
+    uint16_t queued;               // Total bytes enqueued
+    uint16_t flushed;              // Total bytes written in VBlank
+    uint16_t discarded;            // Bytes dropped because a new screen replaced them
+    uint16_t deferred;             // VBlanks that ended with work carried over
+    uint16_t stalls;               // Frames game code waited for queue space
+    uint8_t last_flushed;          // Bytes written in the most recent VBlank
+
+    const struct Asset *bkg_tiles; // Tile set resident at BKG_TILE_BASE, not reloaded
+    uint8_t front;                 // First row of the BG map shown after the queued LCDC changes
+};
+
+// Complete game state structure
+struct GameState {
+    // Core state
+    uint8_t state;
+    
+    // Player state
+    uint8_t player_x;
+    uint8_t player_y;
+    uint8_t facing_right;
+    uint8_t player_state; // 0=standing, 1=casting, 2=reeling
+    struct Metasprite player_sprite;
+    
+    // Casting state
+    uint8_t is_casting;
+    uint8_t cast_power;  // Whole power level, 0 to MAX_CAST_POWER
+    uint8_t cast_charge; // Fine charge the launch speed is taken from
+    uint8_t cast_phase;  // 0=charging, 1=flying, 2=landed
+    
+	uint8_t is_reeling;     // Flag for reeling state
+    int16_t reel_speed;     // Speed at which bobber returns (8.8)
+    // Fishing line state
+    struct LineSegment line[MAX_LINE_SEGMENTS];
+    
+    // Bobber state
+    uint8_t lure_x;         // Whole pixel position, derived from lure_fx/lure_fy
+	uint8_t lure_y;
+	uint16_t lure_fx;       // Position (8.8)
+	uint16_t lure_fy;
+	int16_t lure_vel_x;     // Velocity (8.8)
+	int16_t lure_vel_y;
+	uint8_t lure_state; // 0=normal, 1=splash, 2=bite
+	struct Metasprite lure_sprite;
+    uint8_t splash_timer;
+    uint8_t bite_timer;
+    
+    // Fish states
+    struct FishPool fish;
+    uint8_t has_bite;
+    
+    // Scoring and progression (packed BCD)
+    BCD score;
+    BCD high_score;
+    struct ScoreHud score_hud;
+    uint8_t fish_caught;
+    uint8_t largest_fish;
+	
+	struct ScreenRegion regions[MAX_REGIONS];
+    
+	uint8_t num_regions;
+	uint8_t meter;         // Power bar segments filled on the HUD, 0 when blank
+	
+	// Input state
+	uint8_t prev_input;    // Previous frame's input state
+	uint8_t curr_input;    // Current frame's input state
+	uint8_t pressed;       // Buttons that were just pressed
+	
+	uint8_t is_transition;
+	
+	uint8_t fish_interested;
+};
+
+#ifdef INPUT_LOG
+// SRAM layout: this header, then runs in frame order. The run being recorded
+// is written every frame, so the log stays valid if power is cut.
+struct InputLogHeader {
+    uint16_t magic;
+    uint16_t seed;       // Value rng_seed() was given
+    uint16_t runs;       // Runs stored, including the one in progress
+};
+
+struct InputRun {
+    uint8_t length;      // Frames, 1 to 255
+    uint8_t input;       // curr_input for each of them
+};
+
+struct InputLog {
+    uint8_t mode;
+    uint16_t run;        // Index of the current run
+    uint8_t left;        // Replay: frames still to play from the current run
+};
+#endif
+
+#ifdef PROFILE
+struct ProfileStat {
+    uint8_t min;
+    uint8_t max;
+    uint16_t sum;    // Over the current window
+    uint16_t runs;   // Times the phase ran in the window (ticks, not frames)
+};
+
+struct Profiler {
+    struct ProfileStat stat[PROF_COUNT];
+    uint8_t start[PROF_COUNT];   // LY when each phase began
+    uint8_t frames;              // Frames in the current window
+    uint16_t last_vbl;           // sys_time after the previous frame
+    uint16_t missed_vblanks;     // VBlanks the main loop slept through
+    uint8_t overlay;             // Show results on screen (SELECT toggles)
+};
+#endif
+
+extern struct GameState game;
+extern uint16_t rng_state;
+extern struct VramQueue vram;
+extern struct FrameClock frame_clock;
+extern struct Scheduler sched;
+extern struct Raster raster;
+extern struct TileAnimation water_anim;
+extern uint8_t cgb;                // Running on CGB, in double speed
+extern struct SpriteAllocator sprites;
+extern const uint8_t gameplay_map[MAP_SIZE];
+extern const uint8_t hud_map[SCREEN_WIDTH];
+#ifdef PROFILE
+extern struct Profiler prof;
+#endif
+#ifdef INPUT_LOG
+extern struct InputLog input_log;
+#endif
+
+struct VramCmd *vram_reserve(uint8_t bytes);
+void vram_commit(uint16_t bytes);
+void vram_queue_row(uint8_t x, uint8_t y, uint8_t width, const uint8_t *tiles);
+void vram_queue_fill(uint8_t x, uint8_t y, uint8_t width, uint8_t tile);
+void vram_queue_data(uint8_t first_tile, uint8_t count, const uint8_t *data);
+void vram_flush(void);
+void vbl_isr(void);
+void raster_isr(void);
+void raster_vbl(void);
+void raster_build(void);
+void raster_start(void);
+void raster_stop(void);
+void update_raster(void);
+void vram_queue_map(uint8_t x, uint8_t y, uint8_t width, const uint8_t *tiles);
+void vram_queue_lcdc(uint8_t mask, uint8_t bits);
+void vram_discard(void);
+void vram_dma(uint16_t dst, const uint8_t *src, uint16_t len);
+void cgb_map_attributes(uint8_t row, const uint8_t *map);
+void asset_load(const struct Asset *asset, uint8_t first_tile, uint8_t target);
+void load_screens(void) BANKED;
+void restore_rows(uint8_t row, uint8_t first, uint8_t count);
+void draw_text(uint8_t x, uint8_t y, const char *text);
+void rng_seed(uint16_t seed);
+uint16_t rng_next(void);
+#ifdef INPUT_LOG
+uint16_t input_log_init(uint16_t seed);
+uint8_t input_log_next(uint8_t live);
+#endif
+#ifdef PROFILE
+void profile_reset(void);
+void profile_end(uint8_t id);
+uint16_t profile_avg(const struct ProfileStat *stat);
+void profile_digits(uint8_t *tiles, uint16_t value);
+void profile_draw_overlay(void);
+void profile_frame(void);
+#endif
+void sprites_init(void);
+void vsprite_mark(uint8_t id);
+void line_load_update(uint8_t y, uint8_t add);
+void vsprite_move(uint8_t id, uint8_t x, uint8_t y);
+void vsprite_tile(uint8_t id, uint8_t tile);
+void vsprite_prop(uint8_t id, uint8_t prop);
+void oam_write(uint8_t slot, const struct VSprite *s);
+void update_sprites(void);
+void metasprite_draw(struct Metasprite *m, uint8_t first, const struct MetaFrame *frame, uint8_t x, uint8_t y);
+void metasprite_hide(struct Metasprite *m, uint8_t first);
+void draw_player(void);
+void init_sprites(void);
+void band_link(uint8_t i);
+void band_unlink(uint8_t i);
+void set_fish_y(uint8_t i, uint8_t y);
+void spawn_fish(void);
+void despawn_fish(uint8_t i);
+void find_interested_fish(void);
+void handle_fish(void);
+void line_axis_init(struct LineAxis *a, uint8_t from, uint8_t to);
+void line_axis_step(struct LineAxis *a);
+void update_line(void);
+void set_lure(uint8_t x, uint8_t y);
+void update_lure(void);
+void start_cast(void);
+void reel_axis(uint16_t *pos, uint8_t target);
+void handle_catch(void);
+void update_power_meter(void);
+void attach_score(uint8_t x, uint8_t y, const BCD *value);
+void hud_show(void) BANKED;
+void hud_banner(const char *text) BANKED;
+void add_score(const BCD *points);
+void draw_score(void);
+void update_input(void);
+void handle_input(void);
+void display_title(void) BANKED;
+void display_gameplay(void) BANKED;
+void update_regions(void);
+void display_pause(void) BANKED;
+void remove_pause(void) BANKED;
+void init_game_state(void) BANKED;
+void update_animated_region(struct ScreenRegion* region);
+void add_region(uint8_t x, uint8_t y, uint8_t width, uint8_t height, 
+                uint8_t layer, uint8_t properties, 
+                uint8_t tile_start, uint8_t tile_count,
+                void (*update)(struct ScreenRegion*));
+void clear_regions(void);
+void update_game(void);
+void check_high_score(void);
+void init(void) BANKED;
+void sched_init(void);
+void sched_tick(void);
+void game_tick(void);
+void game_frame(void);
+
+#endif
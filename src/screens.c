@@ -0,0 +1,231 @@
+#pragma bank 255
+// Cold code and data, placed in a switchable bank by the autobanker: screen
+// setup and state transitions. Everything here is BANKED and reached through
+// the GBDK trampoline; it may call into bank 0 freely, and nothing run from
+// the VBlank handler may point in here.
+#include "game.h"
+
+// CGB palettes, lightest color first as in the tiles
+static const uint16_t bkg_palettes[BKG_PAL_COUNT * 4] = {
+    RGB(19, 25, 31), RGB(31, 31, 31), RGB(14, 16, 22), RGB(3, 5, 12),   // Sky
+    RGB(3, 9, 20),   RGB(8, 16, 26),  RGB(12, 20, 29), RGB(20, 28, 31), // Water
+    RGB(25, 18, 10), RGB(19, 12, 6),  RGB(13, 8, 4),   RGB(8, 4, 2),    // Pier
+    RGB(3, 9, 20),   RGB(19, 12, 6),  RGB(13, 8, 4),   RGB(8, 4, 2)     // Post
+};
+
+static const uint16_t obj_palettes[OBJ_PAL_COUNT * 4] = {
+    RGB(31, 31, 31), RGB(31, 24, 18), RGB(8, 10, 26),  RGB(20, 5, 4),   // Player
+    RGB(31, 31, 31), RGB(28, 28, 28), RGB(31, 8, 6),   RGB(31, 28, 6),  // Line, lure
+    RGB(31, 31, 31), RGB(18, 28, 12), RGB(8, 20, 6),   RGB(2, 10, 2),   // Small fish
+    RGB(31, 31, 31), RGB(31, 22, 8),  RGB(28, 14, 2),  RGB(16, 6, 0),   // Medium
+    RGB(31, 31, 31), RGB(22, 18, 28), RGB(14, 10, 22), RGB(6, 4, 12)    // Large
+};
+
+// Title: heading, prompt and the SCORE: label for the high score
+static const uint8_t title_map[MAP_SIZE] = {
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128,  16,  19,  29,  18,  19,  24,  17, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128,  29,  13,  25,  28,  15,   0, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128,  26,  28,  15,  29,  29,   0,  29,  30,  11,  28,  30, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 130,
+};
+
+// Set up both BG maps at once with the LCD off (a frame at most): the title
+// in 9800 on show and gameplay behind it in 9C00, so starting the game is a
+// flip. The window stays off until the HUD takes over 9800. The background
+// tiles are only unpacked if they aren't resident yet. Queued writes are
+// dropped first, since everything is overwritten.
+void load_screens() BANKED {
+    vram_discard();
+    DISPLAY_OFF;
+
+    if(vram.bkg_tiles != &background_asset) {
+        asset_load(&background_asset, BKG_TILE_BASE, ASSET_BKG);
+        vram.bkg_tiles = &background_asset;
+    }
+    memcpy(_SCRN0 + ((uint16_t)TITLE_ROW << 5), title_map, MAP_SIZE);
+    memcpy(_SCRN0 + ((uint16_t)GAME_ROW << 5), gameplay_map, MAP_SIZE);
+    if(cgb) {
+        cgb_map_attributes(TITLE_ROW, title_map);
+        cgb_map_attributes(GAME_ROW, gameplay_map);
+    }
+    LCDC_REG &= ~(LCDCF_BG9C00 | LCDCF_WINON | LCDCF_WIN9C00);
+    vram.front = TITLE_ROW;
+    WX_REG = HUD_WX;
+    WY_REG = HUD_WY;
+
+    DISPLAY_ON;
+}
+
+// Put the HUD in 9800 and show it in the window along with the gameplay map.
+// The BG moves to 9C00 first, since the title still shows 9800's top row and
+// the VBlank budget may split the HUD row; the window comes on once the row
+// and score digits are in, so it appears complete.
+void hud_show() BANKED {
+    vram_queue_lcdc(LCDCF_BG9C00 | LCDCF_WINON | LCDCF_WIN9C00, LCDCF_BG9C00);
+    vram_queue_map(0, HUD_ROW, SCREEN_WIDTH, hud_map);
+    attach_score(HUD_SCORE_X, HUD_ROW, &game.score);
+    draw_score();
+    game.meter = 0;  // hud_map leaves the power bar blank
+    vram_queue_lcdc(0, LCDCF_WINON);
+}
+
+// Show text in place of the power bar (up to METER_SEGMENTS characters).
+// The bar is drawn again on the next update_power_meter().
+void hud_banner(const char *text) BANKED {
+    draw_text(HUD_METER_X, HUD_ROW, text);
+    game.meter = METER_STALE;
+}
+
+void display_title() BANKED {
+    clear_regions();
+    raster_stop();
+
+    // Initialize font system (loads at tile 0)
+    font_t min_font;
+    font_init();
+    min_font = font_load(font_min);
+    font_set(min_font);
+
+    // Sky, water and the text all come from the ROM maps
+    load_screens();
+
+    add_region(0, 0, SCREEN_WIDTH, 10,
+              REGION_LAYER_BKG, 0,
+              128, 1, NULL);  // Sky uses tile 128
+
+    add_region(0, 10, SCREEN_WIDTH, 8,
+          REGION_LAYER_BKG, REGION_PROP_ANIMATED,
+          WATER_TILE, 1, update_animated_region);  // Water uses tile 130
+	game.regions[game.num_regions-1].animation = &water_anim;
+
+    // The text is all on the sky, clear of the animated water
+    attach_score(4, TITLE_ROW + 6, &game.high_score);
+}
+
+void display_gameplay() BANKED {
+    clear_regions();
+    
+    // Add regions for gameplay state (same as before)
+    add_region(0, 0, SCREEN_WIDTH, 9,
+              REGION_LAYER_BKG, 0,
+              128, 1, NULL);  // Sky
+
+    add_region(0, 10, SCREEN_WIDTH, 8,
+              REGION_LAYER_BKG, REGION_PROP_ANIMATED,
+              WATER_TILE, 1, update_animated_region);  // Water
+    game.regions[game.num_regions-1].animation = &water_anim;
+
+    // Gameplay is already drawn in the other map; flip to it with the HUD on
+    hud_show();
+    raster_start();
+}
+
+void display_pause() BANKED {
+    hud_banner(" PAUSED ");
+}
+
+void remove_pause() BANKED {
+    // Bring the power bar back
+    update_power_meter();
+}
+
+void init_game_state() BANKED {
+   // Clear full game state
+   memset(&game, 0, sizeof(game));
+   
+   // Set initial values
+   game.state = STATE_TITLE;
+   game.player_x = 50;
+   game.player_y = PIER_HEIGHT;
+   game.facing_right = 1;
+   game.is_reeling = 0;
+	game.reel_speed = REEL_SPEED;
+   // Initialize fish pool
+   game.fish.free_count = FISH_POOL_SIZE;
+   for(uint8_t i = 0; i < FISH_POOL_SIZE; i++) {
+       game.fish.free[i] = FISH_POOL_SIZE - 1 - i;
+   }
+   memset(game.fish.band_head, NO_FISH, FISH_BANDS);
+   
+   // Initialize line segments
+   for(uint8_t i = 0; i < MAX_LINE_SEGMENTS; i++) {
+       game.line[i].active = 0;
+       game.line[i].sprite_id = LINE_SPRITE + i;
+   }
+}
+
+void init() BANKED {
+   // On CGB take the double speed CPU and the color palettes; DMG carries on
+   // exactly as before
+   if(_cpu == CGB_TYPE) {
+       cpu_fast();
+       cgb = 1;
+       set_bkg_palette(0, BKG_PAL_COUNT, bkg_palettes);
+       set_sprite_palette(0, OBJ_PAL_COUNT, obj_palettes);
+   }
+
+   // Initialize random number generator
+#ifdef INPUT_LOG
+   rng_seed(input_log_init(DIV_REG));
+#else
+   rng_seed(DIV_REG);
+#endif
+
+   // Presentation happens in VBlank; TIMA times the handlers
+   TMA_REG = 0;
+   TAC_REG = TACF_START | TACF_262KHZ;
+   add_VBL(vbl_isr);
+
+   // Raster effects run from the LYC match, disarmed until a table is shown
+   disable_interrupts();
+   LYC_REG = RASTER_LYC_OFF;
+   STAT_REG = STATF_LYC;
+   add_LCD(raster_isr);
+   enable_interrupts();
+   set_interrupts(VBL_IFLAG | LCD_IFLAG);
+
+#ifdef PROFILE
+   profile_reset();
+   prof.last_vbl = sys_time;
+#endif
+   
+   // Set up graphics system
+   SPRITES_8x8;
+   
+   // Initialize all game components
+   init_sprites();
+   init_game_state();
+   sched_init();
+   
+   // Show display layers
+   SHOW_BKG;
+   SHOW_SPRITES;
+}
@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+"""Convert PNG tile sheets to compressed 2bpp assets for asset_load().
+
+    assets.py [--bank N] -o build/gen/assets sheet.png...
+
+Each sheet is cut into 8x8 tiles left to right, top to bottom, so a sheet
+16 pixels wide gives a 16x16 sprite's tiles in top-left, top-right,
+bottom-left, bottom-right order. Pixels map to the four shades by brightness
+(white is color 0, black is color 3). Writes <out>_data.c with the
+compressed streams in ROM bank N (default 1), and <out>.c and <out>.h with
+one `<name>_asset` descriptor per sheet in bank 0, named after the file.
+Prints raw and packed sizes.
+
+Stream format, decoded by asset_load() in src/game.c:
+    0x00-0x7F  n + 1 literal bytes follow
+    0x80-0xFF  copy (n & 0x7F) + 3 bytes from d + 1 back, d is the next byte
+Copies reach back at most 256 bytes, the size of the decoder's ring buffer,
+and may overlap what they produce (distance 1 repeats a byte).
+"""
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+MIN_MATCH = 3
+MAX_MATCH = 0x7F + MIN_MATCH
+MAX_LITERALS = 0x80
+WINDOW = 256
+
+
+def read_png(path):
+    """Return (width, height, rows of brightness 0-255). No PIL needed."""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        sys.exit('%s: not a PNG' % path)
+
+    pos = 8
+    idat = b''
+    palette = None
+    while pos < len(data):
+        length, kind = struct.unpack('>I4s', data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b'IHDR':
+            width, height, depth, color, _, _, interlace = struct.unpack('>IIBBBBB', body)
+        elif kind == b'PLTE':
+            palette = [body[i:i + 3] for i in range(0, len(body), 3)]
+        elif kind == b'IDAT':
+            idat += body
+        elif kind == b'IEND':
+            break
+
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}.get(color)
+    if channels is None or interlace or (depth != 8 and color != 3):
+        sys.exit('%s: use 8-bit gray/RGB or indexed, not interlaced' % path)
+
+    bits = channels * depth
+    stride = (width * bits + 7) // 8
+    bpp = max(1, bits // 8)
+    raw = zlib.decompress(idat)
+    rows = []
+    prev = bytearray(stride)
+    for y in range(height):
+        base = y * (stride + 1)
+        kind = raw[base]
+        line = bytearray(raw[base + 1:base + 1 + stride])
+        for i in range(stride):
+            a = line[i - bpp] if i >= bpp else 0
+            b = prev[i]
+            c = prev[i - bpp] if i >= bpp else 0
+            if kind == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif kind == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif kind == 3:
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xFF
+            elif kind == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pred = a if pa <= pb and pa <= pc else b if pb <= pc else c
+                line[i] = (line[i] + pred) & 0xFF
+        prev = line
+
+        row = []
+        for x in range(width):
+            if color == 3:
+                shift = 8 - depth - (x * depth) % 8
+                index = (line[x * depth // 8] >> shift) & ((1 << depth) - 1)
+                r, g, b = palette[index]
+            elif color in (0, 4):
+                r = g = b = line[x * channels]
+            else:
+                r, g, b = line[x * channels:x * channels + 3]
+            row.append((r * 299 + g * 587 + b * 114) // 1000)
+        rows.append(row)
+    return width, height, rows
+
+
+def png_tiles(path):
+    """2bpp tile data for a sheet: low plane byte, then high, per row."""
+    width, height, rows = read_png(path)
+    if width % 8 or height % 8:
+        sys.exit('%s: %dx%d is not a whole number of tiles' % (path, width, height))
+
+    out = bytearray()
+    for ty in range(0, height, 8):
+        for tx in range(0, width, 8):
+            for y in range(ty, ty + 8):
+                lo = hi = 0
+                for x in range(tx, tx + 8):
+                    shade = min(3, (255 - rows[y][x] + 42) // 85)
+                    lo = (lo << 1) | (shade & 1)
+                    hi = (hi << 1) | (shade >> 1)
+                out += bytes((lo, hi))
+    return bytes(out)
+
+
+def compress(data):
+    """Greedy LZ77 into the stream format above."""
+    out = bytearray()
+    literals = bytearray()
+
+    def flush():
+        for i in range(0, len(literals), MAX_LITERALS):
+            chunk = literals[i:i + MAX_LITERALS]
+            out.append(len(chunk) - 1)
+            out.extend(chunk)
+        literals.clear()
+
+    pos = 0
+    while pos < len(data):
+        best_len = best_dist = 0
+        for dist in range(1, min(pos, WINDOW) + 1):
+            n = 0
+            while (n < MAX_MATCH and pos + n < len(data) and
+                   data[pos + n - dist] == data[pos + n]):
+                n += 1
+            if n > best_len:
+                best_len, best_dist = n, dist
+        if best_len >= MIN_MATCH:
+            flush()
+            out.append(0x80 | (best_len - MIN_MATCH))
+            out.append(best_dist - 1)
+            pos += best_len
+        else:
+            literals.append(data[pos])
+            pos += 1
+    flush()
+    return bytes(out)
+
+
+def decompress(packed, size):
+    """Same steps as asset_load(), to check every asset before it ships."""
+    out = bytearray()
+    src = 0
+    while len(out) < size:
+        c = packed[src]
+        src += 1
+        if c & 0x80:
+            dist = packed[src] + 1
+            src += 1
+            for _ in range((c & 0x7F) + MIN_MATCH):
+                out.append(out[-dist])
+        else:
+            out += packed[src:src + c + 1]
+            src += c + 1
+    return bytes(out[:size])
+
+
+def c_bytes(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append('    ' + ', '.join('0x%02X' % b for b in data[i:i + 16]) + ',')
+    return '\n'.join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('-o', dest='out', required=True, help='output path without extension')
+    parser.add_argument('--bank', type=int, default=1, help='ROM bank for the streams')
+    parser.add_argument('sheets', nargs='+')
+    args = parser.parse_args()
+
+    source = ['// Generated by tools/assets.py, do not edit', '#include "game.h"', '']
+    data = ['#pragma bank %d' % args.bank,
+            '// Generated by tools/assets.py, do not edit', '#include <stdint.h>', '']
+    header = ['// Generated by tools/assets.py, do not edit',
+              '#ifndef ASSETS_H', '#define ASSETS_H', '']
+    total_raw = total_packed = 0
+
+    print('%-12s %6s %6s %6s' % ('asset', 'tiles', 'raw', 'packed'))
+    for path in args.sheets:
+        name = os.path.splitext(os.path.basename(path))[0]
+        raw = png_tiles(path)
+        tiles = len(raw) // 16
+        if tiles > 255:
+            sys.exit('%s: %d tiles, at most 255 per asset' % (path, tiles))
+        packed = compress(raw)
+        if decompress(packed, len(raw)) != raw:
+            sys.exit('%s: compressed stream does not round trip' % path)
+
+        print('%-12s %6d %6d %6d  %3d%%' % (name, tiles, len(raw), len(packed),
+                                           len(packed) * 100 // len(raw)))
+        total_raw += len(raw)
+        total_packed += len(packed)
+
+        data.append('const uint8_t %s_data[] = {' % name)
+        data.append(c_bytes(packed))
+        data.append('};')
+        data.append('')
+        source.append('extern const uint8_t %s_data[];' % name)
+        source.append('const struct Asset %s_asset = { "%s", %d, %d, %d, %s_data };'
+                      % (name, name, args.bank, tiles, len(packed), name))
+        source.append('')
+        header.append('#define %s_TILES %d' % (name.upper(), tiles))
+        header.append('extern const struct Asset %s_asset;' % name)
+
+    print('%-12s %6s %6d %6d  %3d%%' % ('total', '', total_raw, total_packed,
+                                       total_packed * 100 // max(1, total_raw)))
+    header += ['', '#endif', '']
+
+    os.makedirs(os.path.dirname(args.out) or '.', exist_ok=True)
+    with open(args.out + '.c', 'w') as f:
+        f.write('\n'.join(source))
+    with open(args.out + '_data.c', 'w') as f:
+        f.write('\n'.join(data))
+    with open(args.out + '.h', 'w') as f:
+        f.write('\n'.join(header))
+
+
+if __name__ == '__main__':
+    main()
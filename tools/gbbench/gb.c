@@ -0,0 +1,631 @@
+// Headless Game Boy core, see gb.h. Timing is per instruction: the timer and
+// PPU are advanced by each instruction's clock count after it executes.
+#include <string.h>
+#include "gb.h"
+
+// Flags
+#define FZ 0x80
+#define FN 0x40
+#define FH 0x20
+#define FC 0x10
+
+// IO registers, as offsets from FF00
+#define P1 0x00
+#define DIV 0x04
+#define TIMA 0x05
+#define TMA 0x06
+#define TAC 0x07
+#define IF 0x0F
+#define LCDC 0x40
+#define STAT 0x41
+#define LY 0x44
+#define LYC 0x45
+#define DMA 0x46
+
+#define MODE3_START 80
+#define MODE0_START 252
+
+#define R16(hi, lo) ((uint16_t)(((hi) << 8) | (lo)))
+
+static uint8_t ppu_mode(struct Gb *gb) {
+    if(!(gb->io[LCDC] & 0x80)) return 0;
+    if(gb->line >= 144) return 1;
+    if(gb->line_cycle < MODE3_START) return 2;
+    if(gb->line_cycle < MODE0_START) return 3;
+    return 0;
+}
+
+static uint8_t ppu_ly(struct Gb *gb) {
+    return (gb->io[LCDC] & 0x80) ? gb->line : 0;
+}
+
+// Raise the STAT interrupt on a rising edge of any enabled source
+static void ppu_stat(struct Gb *gb) {
+    uint8_t stat = gb->io[STAT];
+    uint8_t mode = ppu_mode(gb);
+    uint8_t level = 0;
+
+    if(gb->io[LCDC] & 0x80) {
+        level = ((stat & 0x08) && mode == 0) ||
+                ((stat & 0x10) && mode == 1) ||
+                ((stat & 0x20) && mode == 2) ||
+                ((stat & 0x40) && gb->line == gb->io[LYC]);
+    }
+    if(level && !gb->stat_line) gb->io[IF] |= 0x02;
+    gb->stat_line = level;
+}
+
+static void frame_end(struct Gb *gb) {
+    gb->last = gb->frame;
+    memset(&gb->frame, 0, sizeof(gb->frame));
+    gb->frames++;
+}
+
+static void tick(struct Gb *gb, uint8_t cycles) {
+    static const uint8_t timer_shift[4] = { 10, 4, 6, 8 };
+    uint16_t old = gb->div;
+
+    gb->total_cycles += cycles;
+    gb->div += cycles;
+    if(gb->io[TAC] & 0x04) {
+        uint8_t shift = timer_shift[gb->io[TAC] & 3];
+        uint32_t ticks = (((uint32_t)old + cycles) >> shift) - (old >> shift);
+        while(ticks--) {
+            if(++gb->io[TIMA] == 0) {
+                gb->io[TIMA] = gb->io[TMA];
+                gb->io[IF] |= 0x04;
+            }
+        }
+    }
+
+    gb->line_cycle += cycles;
+    while(gb->line_cycle >= GB_LINE_CYCLES) {
+        gb->line_cycle -= GB_LINE_CYCLES;
+        if(++gb->line == 154) gb->line = 0;
+        if(gb->line == 144) {
+            if(gb->io[LCDC] & 0x80) gb->io[IF] |= 0x01;
+            frame_end(gb);
+        }
+    }
+    ppu_stat(gb);
+}
+
+static void mbc_write(struct Gb *gb, uint16_t addr, uint8_t value) {
+    if(addr < 0x2000) {
+        gb->ram_enable = (value & 0x0F) == 0x0A;
+    } else if(gb->mbc == 5) {
+        if(addr < 0x4000) gb->frame.bank_switches++;
+        if(addr < 0x3000) gb->rom_bank = (gb->rom_bank & 0x100) | value;
+        else if(addr < 0x4000) gb->rom_bank = (gb->rom_bank & 0xFF) | ((value & 1) << 8);
+        else if(addr < 0x6000) gb->ram_bank = value & 0x0F;
+    } else if(gb->mbc == 1) {
+        if(addr < 0x4000) {
+            gb->frame.bank_switches++;
+            value &= 0x1F;
+            gb->rom_bank = (gb->rom_bank & 0x60) | (value ? value : 1);
+        } else if(addr < 0x6000) {
+            gb->rom_bank = (gb->rom_bank & 0x1F) | ((value & 3) << 5);
+            gb->ram_bank = value & 3;
+        } else {
+            gb->mbc1_mode = value & 1;
+        }
+    }
+}
+
+static uint8_t *sram_ptr(struct Gb *gb, uint16_t addr) {
+    uint8_t bank = gb->ram_bank;
+
+    if(gb->mbc == 1 && !gb->mbc1_mode) bank = 0;
+    return &gb->sram[((bank & 3) << 13) | (addr & 0x1FFF)];
+}
+
+uint8_t gb_read(struct Gb *gb, uint16_t addr) {
+    if(addr < 0x4000) return addr < gb->rom_size ? gb->rom[addr] : 0xFF;
+    if(addr < 0x8000) {
+        size_t offset = ((size_t)(gb->rom_bank % gb->rom_banks) << 14) | (addr & 0x3FFF);
+        return offset < gb->rom_size ? gb->rom[offset] : 0xFF;
+    }
+    if(addr < 0xA000) return gb->vram[addr & 0x1FFF];
+    if(addr < 0xC000) return (gb->ram_enable || !gb->mbc) ? *sram_ptr(gb, addr) : 0xFF;
+    if(addr < 0xFE00) return gb->wram[addr & 0x1FFF];
+    if(addr < 0xFEA0) return gb->oam[addr - 0xFE00];
+    if(addr < 0xFF00) return 0xFF;
+    if(addr < 0xFF80) {
+        uint8_t reg = addr & 0x7F;
+        switch(reg) {
+            case P1: {
+                uint8_t select = gb->io[P1] & 0x30;
+                uint8_t pins = 0x0F;
+                if(!(select & 0x10)) pins &= ~(gb->keys & 0x0F);
+                if(!(select & 0x20)) pins &= ~(gb->keys >> 4);
+                return 0xC0 | select | pins;
+            }
+            case DIV: return gb->div >> 8;
+            case IF: return gb->io[IF] | 0xE0;
+            case LY: return ppu_ly(gb);
+            case STAT:
+                return 0x80 | (gb->io[STAT] & 0x78) |
+                       ((ppu_ly(gb) == gb->io[LYC]) << 2) | ppu_mode(gb);
+        }
+        return gb->io[reg];
+    }
+    if(addr < 0xFFFF) return gb->hram[addr - 0xFF80];
+    return gb->ie;
+}
+
+void gb_write(struct Gb *gb, uint16_t addr, uint8_t value) {
+    if(addr < 0x8000) {
+        mbc_write(gb, addr, value);
+    } else if(addr < 0xA000) {
+        gb->frame.vram_writes++;
+        if(ppu_mode(gb) == 3) gb->frame.vram_blocked++;
+        gb->vram[addr & 0x1FFF] = value;
+    } else if(addr < 0xC000) {
+        if(gb->ram_enable || !gb->mbc) *sram_ptr(gb, addr) = value;
+    } else if(addr < 0xFE00) {
+        gb->wram[addr & 0x1FFF] = value;
+    } else if(addr < 0xFEA0) {
+        gb->frame.oam_writes++;
+        gb->oam[addr - 0xFE00] = value;
+    } else if(addr < 0xFF00) {
+        // Unusable
+    } else if(addr < 0xFF80) {
+        uint8_t reg = addr & 0x7F;
+        switch(reg) {
+            case DIV:
+                gb->div = 0;
+                break;
+            case LCDC:
+                if((value & 0x80) && !(gb->io[LCDC] & 0x80)) {
+                    gb->line = 0;
+                    gb->line_cycle = 0;
+                }
+                gb->io[LCDC] = value;
+                break;
+            case LY:
+                break;
+            case DMA: {
+                uint16_t src = value << 8;
+                for(uint8_t i = 0; i < sizeof(gb->oam); i++) {
+                    gb->oam[i] = gb_read(gb, src + i);
+                }
+                gb->io[DMA] = value;
+                gb->frame.oam_writes += sizeof(gb->oam);
+                gb->frame.oam_dma++;
+                break;
+            }
+            default:
+                gb->io[reg] = value;
+                break;
+        }
+    } else if(addr < 0xFFFF) {
+        gb->hram[addr - 0xFF80] = value;
+    } else {
+        gb->ie = value;
+    }
+}
+
+int gb_init(struct Gb *gb, const uint8_t *rom, size_t rom_size) {
+    uint8_t type;
+
+    memset(gb, 0, sizeof(*gb));
+    if(rom_size < 0x150) return 0;
+    gb->rom = rom;
+    gb->rom_size = rom_size;
+    gb->rom_banks = (rom_size + 0x3FFF) >> 14;
+    gb->rom_bank = 1;
+
+    type = rom[0x147];
+    if(type >= 0x01 && type <= 0x03) gb->mbc = 1;
+    else if(type >= 0x19 && type <= 0x1E) gb->mbc = 5;
+
+    // State left behind by the DMG boot ROM
+    gb->a = 0x01; gb->f = 0xB0;
+    gb->b = 0x00; gb->c = 0x13;
+    gb->d = 0x00; gb->e = 0xD8;
+    gb->h = 0x01; gb->l = 0x4D;
+    gb->sp = 0xFFFE;
+    gb->pc = 0x0100;
+    gb->div = 0xABCC;
+    gb->io[P1] = 0x30;
+    gb->io[IF] = 0x01;
+    gb->io[TAC] = 0x00;
+    gb->io[LCDC] = 0x91;
+    gb->io[STAT] = 0x00;
+    gb->io[0x47] = 0xFC;
+    return 1;
+}
+
+static uint8_t fetch(struct Gb *gb) {
+    return gb_read(gb, gb->pc++);
+}
+
+static uint16_t fetch16(struct Gb *gb) {
+    uint8_t lo = fetch(gb);
+    return R16(fetch(gb), lo);
+}
+
+static void push16(struct Gb *gb, uint16_t value) {
+    gb_write(gb, --gb->sp, value >> 8);
+    gb_write(gb, --gb->sp, value & 0xFF);
+}
+
+static uint16_t pop16(struct Gb *gb) {
+    uint8_t lo = gb_read(gb, gb->sp++);
+    return R16(gb_read(gb, gb->sp++), lo);
+}
+
+static uint16_t hl(struct Gb *gb) {
+    return R16(gb->h, gb->l);
+}
+
+static void set_hl(struct Gb *gb, uint16_t v) {
+    gb->h = v >> 8;
+    gb->l = v & 0xFF;
+}
+
+// r: B C D E H L (HL) A
+static uint8_t reg_get(struct Gb *gb, uint8_t r) {
+    switch(r) {
+        case 0: return gb->b;
+        case 1: return gb->c;
+        case 2: return gb->d;
+        case 3: return gb->e;
+        case 4: return gb->h;
+        case 5: return gb->l;
+        case 6: return gb_read(gb, hl(gb));
+        default: return gb->a;
+    }
+}
+
+static void reg_set(struct Gb *gb, uint8_t r, uint8_t v) {
+    switch(r) {
+        case 0: gb->b = v; break;
+        case 1: gb->c = v; break;
+        case 2: gb->d = v; break;
+        case 3: gb->e = v; break;
+        case 4: gb->h = v; break;
+        case 5: gb->l = v; break;
+        case 6: gb_write(gb, hl(gb), v); break;
+        default: gb->a = v; break;
+    }
+}
+
+// rr: BC DE HL SP
+static uint16_t rr_get(struct Gb *gb, uint8_t rr) {
+    switch(rr) {
+        case 0: return R16(gb->b, gb->c);
+        case 1: return R16(gb->d, gb->e);
+        case 2: return hl(gb);
+        default: return gb->sp;
+    }
+}
+
+static void rr_set(struct Gb *gb, uint8_t rr, uint16_t v) {
+    switch(rr) {
+        case 0: gb->b = v >> 8; gb->c = v & 0xFF; break;
+        case 1: gb->d = v >> 8; gb->e = v & 0xFF; break;
+        case 2: set_hl(gb, v); break;
+        default: gb->sp = v; break;
+    }
+}
+
+static uint8_t condition(struct Gb *gb, uint8_t cc) {
+    switch(cc) {
+        case 0: return !(gb->f & FZ);
+        case 1: return (gb->f & FZ) != 0;
+        case 2: return !(gb->f & FC);
+        default: return (gb->f & FC) != 0;
+    }
+}
+
+// op: ADD ADC SUB SBC AND XOR OR CP
+static void alu(struct Gb *gb, uint8_t op, uint8_t v) {
+    uint8_t a = gb->a;
+    uint8_t carry = (op == 1 || op == 3) && (gb->f & FC);
+    uint16_t r;
+
+    switch(op) {
+        case 0:
+        case 1:
+            r = a + v + carry;
+            gb->f = ((r & 0xFF) ? 0 : FZ) |
+                    (((a & 0x0F) + (v & 0x0F) + carry) > 0x0F ? FH : 0) |
+                    (r > 0xFF ? FC : 0);
+            gb->a = r;
+            break;
+        case 2:
+        case 3:
+        case 7:
+            r = a - v - carry;
+            gb->f = ((r & 0xFF) ? 0 : FZ) | FN |
+                    ((a & 0x0F) < (v & 0x0F) + carry ? FH : 0) |
+                    (a < v + carry ? FC : 0);
+            if(op != 7) gb->a = r;
+            break;
+        case 4:
+            gb->a = a & v;
+            gb->f = (gb->a ? 0 : FZ) | FH;
+            break;
+        case 5:
+            gb->a = a ^ v;
+            gb->f = gb->a ? 0 : FZ;
+            break;
+        default:
+            gb->a = a | v;
+            gb->f = gb->a ? 0 : FZ;
+            break;
+    }
+}
+
+// op: RLC RRC RL RR SLA SRA SWAP SRL
+static uint8_t shift(struct Gb *gb, uint8_t op, uint8_t v) {
+    uint8_t carry = (gb->f & FC) != 0;
+    uint8_t out;
+    uint8_t r;
+
+    switch(op) {
+        case 0: out = v >> 7; r = (v << 1) | out; break;
+        case 1: out = v & 1; r = (v >> 1) | (out << 7); break;
+        case 2: out = v >> 7; r = (v << 1) | carry; break;
+        case 3: out = v & 1; r = (v >> 1) | (carry << 7); break;
+        case 4: out = v >> 7; r = v << 1; break;
+        case 5: out = v & 1; r = (v >> 1) | (v & 0x80); break;
+        case 6: out = 0; r = (v << 4) | (v >> 4); break;
+        default: out = v & 1; r = v >> 1; break;
+    }
+    gb->f = (r ? 0 : FZ) | (out ? FC : 0);
+    return r;
+}
+
+static uint8_t execute_cb(struct Gb *gb) {
+    uint8_t op = fetch(gb);
+    uint8_t r = op & 7;
+    uint8_t bit = (op >> 3) & 7;
+    uint8_t v = reg_get(gb, r);
+
+    switch(op >> 6) {
+        case 0:
+            reg_set(gb, r, shift(gb, bit, v));
+            break;
+        case 1:
+            gb->f = (gb->f & FC) | FH | ((v >> bit) & 1 ? 0 : FZ);
+            return r == 6 ? 12 : 8;
+        case 2:
+            reg_set(gb, r, v & ~(1 << bit));
+            break;
+        default:
+            reg_set(gb, r, v | (1 << bit));
+            break;
+    }
+    return r == 6 ? 16 : 8;
+}
+
+static uint16_t add_sp(struct Gb *gb) {
+    int8_t offset = (int8_t)fetch(gb);
+    uint8_t u = (uint8_t)offset;
+
+    gb->f = (((gb->sp & 0x0F) + (u & 0x0F)) > 0x0F ? FH : 0) |
+            (((gb->sp & 0xFF) + u) > 0xFF ? FC : 0);
+    return gb->sp + offset;
+}
+
+static uint8_t execute(struct Gb *gb) {
+    uint8_t op = fetch(gb);
+    uint8_t x = (op >> 3) & 7;
+    uint8_t z = op & 7;
+    uint16_t t;
+    uint8_t v;
+
+    // LD r,r' and HALT
+    if(op >= 0x40 && op < 0x80) {
+        if(op == 0x76) {
+            if(!gb->ime && (gb->ie & gb->io[IF] & 0x1F)) return 4;  // HALT bug not modelled
+            gb->halted = 1;
+            gb->frame.halts++;
+            return 4;
+        }
+        reg_set(gb, x, reg_get(gb, z));
+        return (x == 6 || z == 6) ? 8 : 4;
+    }
+    // ALU A,r
+    if(op >= 0x80 && op < 0xC0) {
+        alu(gb, x, reg_get(gb, z));
+        return z == 6 ? 8 : 4;
+    }
+
+    if(op < 0x40) {
+        switch(op & 0x0F) {
+            case 0x01:
+                rr_set(gb, op >> 4, fetch16(gb));
+                return 12;
+            case 0x03:
+                rr_set(gb, op >> 4, rr_get(gb, op >> 4) + 1);
+                return 8;
+            case 0x0B:
+                rr_set(gb, op >> 4, rr_get(gb, op >> 4) - 1);
+                return 8;
+            case 0x09: {
+                uint16_t a = hl(gb);
+                uint16_t b = rr_get(gb, op >> 4);
+                gb->f = (gb->f & FZ) |
+                        (((a & 0x0FFF) + (b & 0x0FFF)) > 0x0FFF ? FH : 0) |
+                        ((uint32_t)a + b > 0xFFFF ? FC : 0);
+                set_hl(gb, a + b);
+                return 8;
+            }
+        }
+        switch(z) {
+            case 4:
+                v = reg_get(gb, x) + 1;
+                reg_set(gb, x, v);
+                gb->f = (gb->f & FC) | (v ? 0 : FZ) | ((v & 0x0F) == 0 ? FH : 0);
+                return x == 6 ? 12 : 4;
+            case 5:
+                v = reg_get(gb, x) - 1;
+                reg_set(gb, x, v);
+                gb->f = (gb->f & FC) | FN | (v ? 0 : FZ) | ((v & 0x0F) == 0x0F ? FH : 0);
+                return x == 6 ? 12 : 4;
+            case 6:
+                reg_set(gb, x, fetch(gb));
+                return x == 6 ? 12 : 8;
+        }
+    }
+
+    switch(op) {
+        case 0x00: return 4;
+        case 0x02: gb_write(gb, R16(gb->b, gb->c), gb->a); return 8;
+        case 0x12: gb_write(gb, R16(gb->d, gb->e), gb->a); return 8;
+        case 0x22: gb_write(gb, hl(gb), gb->a); set_hl(gb, hl(gb) + 1); return 8;
+        case 0x32: gb_write(gb, hl(gb), gb->a); set_hl(gb, hl(gb) - 1); return 8;
+        case 0x0A: gb->a = gb_read(gb, R16(gb->b, gb->c)); return 8;
+        case 0x1A: gb->a = gb_read(gb, R16(gb->d, gb->e)); return 8;
+        case 0x2A: gb->a = gb_read(gb, hl(gb)); set_hl(gb, hl(gb) + 1); return 8;
+        case 0x3A: gb->a = gb_read(gb, hl(gb)); set_hl(gb, hl(gb) - 1); return 8;
+        case 0x07: gb->a = shift(gb, 0, gb->a); gb->f &= ~FZ; return 4;
+        case 0x0F: gb->a = shift(gb, 1, gb->a); gb->f &= ~FZ; return 4;
+        case 0x17: gb->a = shift(gb, 2, gb->a); gb->f &= ~FZ; return 4;
+        case 0x1F: gb->a = shift(gb, 3, gb->a); gb->f &= ~FZ; return 4;
+        case 0x08:
+            t = fetch16(gb);
+            gb_write(gb, t, gb->sp & 0xFF);
+            gb_write(gb, t + 1, gb->sp >> 8);
+            return 20;
+        case 0x10: fetch(gb); return 4;
+        case 0x18: t = (int8_t)fetch(gb); gb->pc += t; return 12;
+        case 0x20: case 0x28: case 0x30: case 0x38:
+            t = (int8_t)fetch(gb);
+            if(!condition(gb, (op >> 3) & 3)) return 8;
+            gb->pc += t;
+            return 12;
+        case 0x27: {
+            uint8_t a = gb->a;
+            uint8_t carry = gb->f & FC;
+            if(!(gb->f & FN)) {
+                if(carry || a > 0x99) { a += 0x60; carry = FC; }
+                if((gb->f & FH) || (a & 0x0F) > 0x09) a += 0x06;
+            } else {
+                if(carry) a -= 0x60;
+                if(gb->f & FH) a -= 0x06;
+            }
+            gb->a = a;
+            gb->f = (gb->f & FN) | (a ? 0 : FZ) | carry;
+            return 4;
+        }
+        case 0x2F: gb->a = ~gb->a; gb->f |= FN | FH; return 4;
+        case 0x37: gb->f = (gb->f & FZ) | FC; return 4;
+        case 0x3F: gb->f = (gb->f & FZ) | ((gb->f & FC) ^ FC); return 4;
+
+        case 0xC0: case 0xC8: case 0xD0: case 0xD8:
+            if(!condition(gb, (op >> 3) & 3)) return 8;
+            gb->pc = pop16(gb);
+            return 20;
+        case 0xC9: gb->pc = pop16(gb); return 16;
+        case 0xD9:
+            gb->pc = pop16(gb);
+            gb->ime = 1;
+            if(gb->isr_depth) gb->isr_depth--;
+            return 16;
+        case 0xC1: t = pop16(gb); gb->b = t >> 8; gb->c = t & 0xFF; return 12;
+        case 0xD1: t = pop16(gb); gb->d = t >> 8; gb->e = t & 0xFF; return 12;
+        case 0xE1: set_hl(gb, pop16(gb)); return 12;
+        case 0xF1: t = pop16(gb); gb->a = t >> 8; gb->f = t & 0xF0; return 12;
+        case 0xC5: push16(gb, R16(gb->b, gb->c)); return 16;
+        case 0xD5: push16(gb, R16(gb->d, gb->e)); return 16;
+        case 0xE5: push16(gb, hl(gb)); return 16;
+        case 0xF5: push16(gb, R16(gb->a, gb->f)); return 16;
+        case 0xC2: case 0xCA: case 0xD2: case 0xDA:
+            t = fetch16(gb);
+            if(!condition(gb, (op >> 3) & 3)) return 12;
+            gb->pc = t;
+            return 16;
+        case 0xC3: gb->pc = fetch16(gb); return 16;
+        case 0xE9: gb->pc = hl(gb); return 4;
+        case 0xC4: case 0xCC: case 0xD4: case 0xDC:
+            t = fetch16(gb);
+            if(!condition(gb, (op >> 3) & 3)) return 12;
+            push16(gb, gb->pc);
+            gb->pc = t;
+            return 24;
+        case 0xCD:
+            t = fetch16(gb);
+            push16(gb, gb->pc);
+            gb->pc = t;
+            return 24;
+        case 0xC6: case 0xCE: case 0xD6: case 0xDE:
+        case 0xE6: case 0xEE: case 0xF6: case 0xFE:
+            alu(gb, x, fetch(gb));
+            return 8;
+        case 0xC7: case 0xCF: case 0xD7: case 0xDF:
+        case 0xE7: case 0xEF: case 0xF7: case 0xFF:
+            push16(gb, gb->pc);
+            gb->pc = op & 0x38;
+            return 16;
+        case 0xCB: return execute_cb(gb);
+        case 0xE0: gb_write(gb, 0xFF00 | fetch(gb), gb->a); return 12;
+        case 0xF0: gb->a = gb_read(gb, 0xFF00 | fetch(gb)); return 12;
+        case 0xE2: gb_write(gb, 0xFF00 | gb->c, gb->a); return 8;
+        case 0xF2: gb->a = gb_read(gb, 0xFF00 | gb->c); return 8;
+        case 0xEA: gb_write(gb, fetch16(gb), gb->a); return 16;
+        case 0xFA: gb->a = gb_read(gb, fetch16(gb)); return 16;
+        case 0xE8: gb->sp = add_sp(gb); return 16;
+        case 0xF8: set_hl(gb, add_sp(gb)); return 12;
+        case 0xF9: gb->sp = hl(gb); return 8;
+        case 0xF3: gb->ime = 0; gb->ime_delay = 0; return 4;
+        case 0xFB: if(!gb->ime) gb->ime_delay = 2; return 4;
+    }
+
+    // D3 DB DD E3 E4 EB EC ED F4 FC FD hang the CPU
+    gb->pc--;
+    gb->locked = 1;
+    return 4;
+}
+
+uint8_t gb_step(struct Gb *gb) {
+    uint8_t pending;
+    uint8_t cycles;
+    uint8_t in_isr = gb->isr_depth != 0;
+
+    if(gb->ime_delay && --gb->ime_delay == 0) gb->ime = 1;
+
+    pending = gb->ie & gb->io[IF] & 0x1F;
+    if(gb->halted) {
+        if(!pending) {
+            gb->frame.cycles += 4;
+            if(in_isr) gb->frame.isr += 4;
+            tick(gb, 4);
+            return 4;
+        }
+        gb->halted = 0;
+    }
+
+    if(gb->ime && pending) {
+        uint8_t n = 0;
+        while(!(pending & (1 << n))) n++;
+        if(n == 1) gb->frame.stat_irqs++;
+        gb->io[IF] &= ~(1 << n);
+        gb->ime = 0;
+        push16(gb, gb->pc);
+        gb->pc = 0x40 + n * 8;
+        gb->isr_depth++;
+        cycles = 20;
+        in_isr = 1;
+    } else if(gb->locked) {
+        cycles = 4;
+    } else {
+        cycles = execute(gb);
+        in_isr |= gb->isr_depth != 0;
+    }
+
+    gb->frame.cycles += cycles;
+    gb->frame.busy += cycles;
+    if(in_isr) gb->frame.isr += cycles;
+    tick(gb, cycles);
+    return cycles;
+}
+
+void gb_run_frame(struct Gb *gb) {
+    uint32_t frame = gb->frames;
+
+    while(gb->frames == frame) gb_step(gb);
+}
@@ -0,0 +1,74 @@
+// Minimal headless Game Boy core for benchmarking: SM83 CPU, MBC1/MBC5,
+// timer, joypad, OAM DMA and PPU timing (modes, LY, STAT/VBlank interrupts).
+// Nothing is rendered; the point is counting cycles and memory traffic.
+#ifndef GB_H
+#define GB_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define GB_FRAME_CYCLES 70224
+#define GB_LINE_CYCLES 456
+
+// Counters for one frame, from the start of one VBlank to the next
+struct GbFrame {
+    uint32_t cycles;         // Total clocks (always GB_FRAME_CYCLES apart from LCD toggles)
+    uint32_t busy;           // Clocks not spent halted
+    uint32_t isr;            // Clocks inside interrupt handlers
+    uint32_t halts;          // HALT instructions executed
+    uint32_t vram_writes;    // CPU writes to 8000-9FFF
+    uint32_t vram_blocked;   // ... of which landed while the PPU owned VRAM (mode 3)
+    uint32_t oam_writes;     // CPU writes to FE00-FE9F plus bytes moved by DMA
+    uint32_t oam_dma;        // DMA transfers started
+    uint32_t stat_irqs;      // STAT interrupts taken (LYC raster effects)
+    uint32_t bank_switches;  // Writes to the MBC ROM bank registers
+};
+
+struct Gb {
+    // CPU
+    uint8_t a, f, b, c, d, e, h, l;
+    uint16_t sp, pc;
+    uint8_t ime;
+    uint8_t ime_delay;       // EI takes effect after the next instruction
+    uint8_t halted;
+    uint8_t isr_depth;
+    uint8_t locked;          // Hit an illegal opcode
+
+    // Memory
+    const uint8_t *rom;
+    size_t rom_size;
+    uint16_t rom_banks;
+    uint8_t mbc;             // 0 none, 1 MBC1, 5 MBC5
+    uint16_t rom_bank;
+    uint8_t ram_bank;
+    uint8_t ram_enable;
+    uint8_t mbc1_mode;
+    uint8_t vram[0x2000];
+    uint8_t sram[0x8000];
+    uint8_t wram[0x2000];
+    uint8_t oam[0xA0];
+    uint8_t io[0x80];
+    uint8_t hram[0x7F];
+    uint8_t ie;
+
+    // Timer and PPU
+    uint16_t div;            // Internal 16-bit divider, DIV is the high byte
+    uint16_t line_cycle;
+    uint8_t line;            // Scanline the PPU is on, even with the LCD off
+    uint8_t stat_line;       // Level of the STAT interrupt line
+    uint8_t keys;            // Held buttons, in GBDK J_* layout
+
+    // Accounting
+    uint64_t total_cycles;
+    struct GbFrame frame;    // Frame in progress
+    struct GbFrame last;     // Most recently completed frame
+    uint32_t frames;         // Frames completed
+};
+
+int gb_init(struct Gb *gb, const uint8_t *rom, size_t rom_size);
+uint8_t gb_read(struct Gb *gb, uint16_t addr);
+void gb_write(struct Gb *gb, uint16_t addr, uint8_t value);
+uint8_t gb_step(struct Gb *gb);   // One instruction or interrupt; returns clocks
+void gb_run_frame(struct Gb *gb); // Until the next VBlank starts
+
+#endif
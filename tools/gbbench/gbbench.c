@@ -0,0 +1,218 @@
+// Runs the ROM headless through scripted scenarios and reports, per
+// scenario, CPU cycles per frame, lag frames, VRAM/OAM writes, and STAT
+// interrupts and bank switches, which show the ROM's raster effects and
+// banked code are actually running.
+//
+//   gbbench [--csv] [--scenario name] rom.gb
+//
+// Default output is one JSON object per scenario; --csv prints every frame.
+// A frame runs from one VBlank to the next. Busy cycles exclude time halted
+// waiting for VBlank, and a lag frame is one where the game never halted.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gb.h"
+
+// GBDK joypad bits
+#define J_START  0x80
+#define J_SELECT 0x40
+#define J_B      0x20
+#define J_A      0x10
+#define J_DOWN   0x08
+#define J_UP     0x04
+#define J_LEFT   0x02
+#define J_RIGHT  0x01
+
+#define MAX_STEPS 64
+
+struct Step {
+    uint16_t frames;
+    uint8_t keys;
+    uint8_t measure;   // Count these frames in the results
+};
+
+struct Scenario {
+    const char *name;
+    struct Step steps[MAX_STEPS];
+};
+
+// Boot, then leave the title screen
+#define PROLOGUE { 60, 0, 0 }, { 2, J_START, 0 }, { 30, 0, 0 }
+
+// Bites are random, so the reel scenario waits long enough for fish to gather
+// and then pulls in short tugs; a fish within reach is hooked by the first one
+static const struct Scenario scenarios[] = {
+    { "title_idle", {
+        { 30, 0, 0 },
+        { 600, 0, 1 },
+    } },
+    { "walking", {
+        PROLOGUE,
+        { 90, J_LEFT, 1 }, { 90, J_RIGHT, 1 },
+        { 90, J_LEFT, 1 }, { 90, J_RIGHT, 1 },
+    } },
+    { "full_power_cast", {
+        PROLOGUE,
+        { 50, J_A, 1 },
+        { 300, 0, 1 },
+    } },
+    { "reel_hooked", {
+        PROLOGUE,
+        { 30, J_A, 0 },
+        { 360, 0, 0 },
+        { 8, J_B, 1 }, { 16, 0, 1 }, { 8, J_B, 1 }, { 16, 0, 1 },
+        { 8, J_B, 1 }, { 16, 0, 1 }, { 8, J_B, 1 }, { 16, 0, 1 },
+        { 240, J_B, 1 },
+    } },
+    { "pause", {
+        PROLOGUE,
+        { 60, 0, 0 },
+        { 4, J_START, 1 },
+        { 300, 0, 1 },
+        { 4, J_START, 1 },
+        { 120, 0, 1 },
+    } },
+};
+
+#define SCENARIO_COUNT (sizeof(scenarios) / sizeof(scenarios[0]))
+
+struct Stat {
+    unsigned long long sum;
+    uint32_t max;
+    uint32_t max_frame;
+};
+
+struct Result {
+    uint32_t frames;
+    uint32_t lag_frames;
+    struct Stat busy, isr, vram, vram_blocked, oam, dma, stat_irqs, banks;
+};
+
+static void stat_add(struct Stat *s, uint32_t v, uint32_t frame) {
+    s->sum += v;
+    if(v > s->max) {
+        s->max = v;
+        s->max_frame = frame;
+    }
+}
+
+static void stat_json(const char *name, const struct Stat *s, uint32_t frames) {
+    printf(", \"%s_avg\": %.1f, \"%s_max\": %u, \"%s_max_frame\": %u",
+           name, frames ? (double)s->sum / frames : 0.0,
+           name, (unsigned)s->max, name, (unsigned)s->max_frame);
+}
+
+static int run_scenario(const struct Scenario *sc, const uint8_t *rom, size_t rom_size, int csv) {
+    static struct Gb gb;
+    struct Result r;
+    uint32_t frame = 0;
+
+    memset(&r, 0, sizeof(r));
+    if(!gb_init(&gb, rom, rom_size)) return 0;
+
+    for(const struct Step *step = sc->steps; step->frames; step++) {
+        for(uint16_t n = 0; n < step->frames; n++, frame++) {
+            const struct GbFrame *f = &gb.last;
+
+            gb.keys = step->keys;
+            gb_run_frame(&gb);
+            if(gb.locked) {
+                fprintf(stderr, "%s: CPU locked up at %04X\n", sc->name, gb.pc);
+                return 0;
+            }
+            if(!step->measure) continue;
+
+            r.frames++;
+            if(!f->halts) r.lag_frames++;
+            stat_add(&r.busy, f->busy, frame);
+            stat_add(&r.isr, f->isr, frame);
+            stat_add(&r.vram, f->vram_writes, frame);
+            stat_add(&r.vram_blocked, f->vram_blocked, frame);
+            stat_add(&r.oam, f->oam_writes, frame);
+            stat_add(&r.dma, f->oam_dma, frame);
+            stat_add(&r.stat_irqs, f->stat_irqs, frame);
+            stat_add(&r.banks, f->bank_switches, frame);
+            if(csv) {
+                printf("%s,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n", sc->name, (unsigned)frame,
+                       (unsigned)f->cycles, (unsigned)f->busy, (unsigned)f->isr,
+                       (unsigned)f->halts, (unsigned)f->vram_writes,
+                       (unsigned)f->vram_blocked, (unsigned)f->oam_writes,
+                       (unsigned)f->oam_dma, (unsigned)f->stat_irqs,
+                       (unsigned)f->bank_switches);
+            }
+        }
+    }
+
+    if(!csv) {
+        printf("{\"scenario\": \"%s\", \"frames\": %u, \"lag_frames\": %u",
+               sc->name, (unsigned)r.frames, (unsigned)r.lag_frames);
+        stat_json("cycles", &r.busy, r.frames);
+        stat_json("isr_cycles", &r.isr, r.frames);
+        stat_json("vram_writes", &r.vram, r.frames);
+        stat_json("vram_blocked", &r.vram_blocked, r.frames);
+        stat_json("oam_writes", &r.oam, r.frames);
+        stat_json("oam_dma", &r.dma, r.frames);
+        stat_json("stat_irqs", &r.stat_irqs, r.frames);
+        stat_json("bank_switches", &r.banks, r.frames);
+        printf(", \"frame_cycles\": %u}\n", GB_FRAME_CYCLES);
+    }
+    return 1;
+}
+
+static uint8_t *load_rom(const char *path, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    uint8_t *rom;
+    long len;
+
+    if(!f) {
+        perror(path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    rom = len > 0 ? malloc(len) : NULL;
+    if(!rom || fread(rom, 1, len, f) != (size_t)len) {
+        fprintf(stderr, "%s: read failed\n", path);
+        free(rom);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+    *size = len;
+    return rom;
+}
+
+int main(int argc, char **argv) {
+    const char *only = NULL;
+    const char *path = NULL;
+    int csv = 0;
+    int ran = 0;
+    uint8_t *rom;
+    size_t rom_size;
+
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "--csv")) csv = 1;
+        else if(!strcmp(argv[i], "--scenario") && i + 1 < argc) only = argv[++i];
+        else path = argv[i];
+    }
+    if(!path) {
+        fprintf(stderr, "usage: %s [--csv] [--scenario name] rom.gb\n", argv[0]);
+        return 2;
+    }
+    rom = load_rom(path, &rom_size);
+    if(!rom) return 1;
+
+    if(csv) printf("scenario,frame,cycles,busy,isr,halts,vram_writes,vram_blocked,oam_writes,oam_dma,stat_irqs,bank_switches\n");
+    for(size_t i = 0; i < SCENARIO_COUNT; i++) {
+        if(only && strcmp(only, scenarios[i].name)) continue;
+        if(!run_scenario(&scenarios[i], rom, rom_size, csv)) return 1;
+        ran++;
+    }
+    free(rom);
+    if(!ran) {
+        fprintf(stderr, "no scenario named %s\n", only);
+        return 2;
+    }
+    return 0;
+}